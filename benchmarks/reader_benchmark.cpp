@@ -0,0 +1,351 @@
+// Throughput benchmark for the mesh readers.
+//
+// Generates deterministic synthetic meshes (a wavy sheet triangulated on a
+// regular grid) at growing face counts, writes them in every supported
+// format and times STLReader / NASReader / CMZReader over a range of thread
+// counts. Output follows Google Benchmark's console layout, optionally also
+// as JSON for regression tracking:
+//
+//   reader_benchmark [--min-faces N] [--max-faces N] [--threads 1,2,4]
+//                    [--repetitions N] [--formats stl,stl_ascii,nas,nas_large,cmz]
+//                    [--dir PATH] [--json FILE]
+//
+// Files are read with the cache disabled and after one warm-up read, so the
+// numbers measure parsing from the page cache rather than disk speed. The
+// files are rewritten on every run, so they always come from the current
+// writers.
+//
+// PeakRSS is the resident memory the timed reads add on top of what the
+// process held before them. On Linux the kernel high-water mark is reset
+// per case (/proc/self/clear_refs, VmHWM). Elsewhere only the lifetime peak
+// of the process is available; it is reported as is and marked
+// "peak_rss_scope": "process" in the JSON.
+
+#include "mesh_reader.hpp"
+#include "mesh_writer.hpp"
+#include "parallel_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+using cfd::MeshData;
+
+struct Options {
+    size_t min_faces = 10000;
+    size_t max_faces = 1000000;
+    std::vector<unsigned> threads;
+    int repetitions = 3;
+    std::vector<std::string> formats = {"stl", "stl_ascii", "nas", "nas_large", "cmz"};
+    std::string dir;
+    std::string json_path;
+};
+
+struct Result {
+    std::string name;
+    std::string format;
+    size_t faces = 0;
+    unsigned threads = 0;
+    uint64_t bytes = 0;
+    double seconds = 0.0;  // Fastest repetition
+    uint64_t peak_rss = 0;      // Peak resident memory above baseline_rss during the timed reads
+    uint64_t baseline_rss = 0;  // Resident memory before the timed reads (0 for process scope)
+    bool per_case_rss = false;  // False: peak_rss is the process-lifetime peak
+};
+
+#ifdef __linux__
+// Field of /proc/self/status such as "VmHWM" in bytes, 0 if missing
+uint64_t proc_status_bytes(const char* field) {
+    std::ifstream status("/proc/self/status");
+    const std::string prefix = std::string(field) + ":";
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            return std::strtoull(line.c_str() + prefix.size(), nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+#endif
+
+// Starts a new peak measurement and returns the current resident set size,
+// or returns false when the platform cannot reset the high-water mark
+bool reset_peak_rss(uint64_t& current) {
+#ifdef __linux__
+#ifdef __GLIBC__
+    // Hand freed heap memory (e.g. the warm-up result) back to the kernel so
+    // that reusing it counts towards the peak
+    malloc_trim(0);
+#endif
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (!(clear_refs << "5" << std::flush)) {
+        return false;
+    }
+    current = proc_status_bytes("VmRSS");
+    return current != 0;
+#else
+    (void)current;
+    return false;
+#endif
+}
+
+// Peak resident set size since the last successful reset_peak_rss(), or of
+// the process so far, in bytes
+uint64_t peak_rss_bytes() {
+#ifdef __linux__
+    const uint64_t hwm = proc_status_bytes("VmHWM");
+    if (hwm != 0) {
+        return hwm;
+    }
+#endif
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return uint64_t(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return uint64_t(usage.ru_maxrss);
+#else
+    return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Wavy sheet on an nx x ny vertex grid with two triangles per cell, giving
+// at least `faces` faces. Coordinates carry a deterministic jitter so the
+// text formats do not compress to short repeated numbers.
+MeshData generate_sheet(size_t faces) {
+    const size_t cells = (faces + 1) / 2;
+    const size_t nx = std::max<size_t>(2, size_t(std::ceil(std::sqrt(double(cells)))) + 1);
+    const size_t ny = std::max<size_t>(2, (cells + nx - 2) / (nx - 1) + 1);
+
+    MeshData mesh;
+    mesh.vertices.resize(Eigen::Index(nx * ny), 3);
+    uint32_t state = 12345u;
+    for (size_t j = 0; j < ny; ++j) {
+        for (size_t i = 0; i < nx; ++i) {
+            state = state * 1664525u + 1013904223u;
+            const float jitter = float(state >> 8) / float(1u << 24) * 1e-3f;
+            const float x = float(i) * 0.01f + jitter;
+            const float y = float(j) * 0.01f - jitter;
+            const float z = 0.05f * std::sin(x * 7.0f) * std::cos(y * 5.0f);
+            mesh.vertices.row(Eigen::Index(j * nx + i)) << x, y, z;
+        }
+    }
+
+    mesh.faces.resize(Eigen::Index((nx - 1) * (ny - 1) * 2), 3);
+    Eigen::Index f = 0;
+    for (size_t j = 0; j + 1 < ny; ++j) {
+        for (size_t i = 0; i + 1 < nx; ++i) {
+            const int a = int(j * nx + i);
+            const int b = a + 1;
+            const int c = a + int(nx);
+            const int d = c + 1;
+            mesh.faces.row(f++) << a, b, d;
+            mesh.faces.row(f++) << a, d, c;
+        }
+    }
+    return mesh;
+}
+
+std::string file_name(const std::string& format, size_t faces) {
+    const std::string ext = format == "cmz" ? ".cmz" : format.rfind("stl", 0) == 0 ? ".stl" : ".nas";
+    return "sheet_" + std::to_string(faces) + "_" + format + ext;
+}
+
+void write_format(const MeshData& mesh, const std::string& format, const std::string& path) {
+    cfd::WriteOptions options;
+    options.ascii_stl = format == "stl_ascii";
+    options.nas_large_field = format == "nas_large";
+    cfd::create_mesh_writer(path, options)->write(mesh, path);
+}
+
+Result run_case(const std::string& path, const std::string& format, size_t faces,
+                unsigned threads, int repetitions) {
+    cfd::ReadOptions options;
+    options.num_threads = threads;
+    options.use_cache = false;
+    auto reader = cfd::create_mesh_reader(path, options);
+
+    Result result;
+    result.format = format;
+    result.threads = threads;
+    result.bytes = std::filesystem::file_size(path);
+    result.seconds = 1e300;
+
+    // Warm-up: pulls the file into the page cache and the allocator pools.
+    // Its result is released before the memory baseline is taken.
+    {
+        const MeshData mesh = reader->read(path);
+        if (size_t(mesh.faces.rows()) < faces) {
+            throw std::runtime_error("Benchmark file decoded to too few faces: " + path);
+        }
+        result.faces = size_t(mesh.faces.rows());
+    }
+
+    result.per_case_rss = reset_peak_rss(result.baseline_rss);
+    for (int r = 0; r < repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        const MeshData mesh = reader->read(path);
+        const auto stop = std::chrono::steady_clock::now();
+        result.seconds = std::min(result.seconds, std::chrono::duration<double>(stop - start).count());
+    }
+    const uint64_t peak = peak_rss_bytes();
+    if (!result.per_case_rss) {
+        result.baseline_rss = 0;
+    }
+    result.peak_rss = peak > result.baseline_rss ? peak - result.baseline_rss : 0;
+
+    std::ostringstream name;
+    name << "BM_Read/" << format << "/" << faces << "/threads:" << threads;
+    result.name = name.str();
+    return result;
+}
+
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+Options parse_arguments(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--min-faces") {
+            options.min_faces = std::stoull(value());
+        } else if (arg == "--max-faces") {
+            options.max_faces = std::stoull(value());
+        } else if (arg == "--threads") {
+            for (const std::string& t : split_list(value())) options.threads.push_back(unsigned(std::stoul(t)));
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max(1, std::stoi(value()));
+        } else if (arg == "--formats") {
+            options.formats = split_list(value());
+        } else if (arg == "--dir") {
+            options.dir = value();
+        } else if (arg == "--json") {
+            options.json_path = value();
+        } else {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+    if (options.threads.empty()) {
+        // Powers of two up to the core count, plus the core count itself
+        const unsigned cores = cfd::default_thread_count();
+        for (unsigned t = 1; t < cores; t *= 2) options.threads.push_back(t);
+        options.threads.push_back(cores);
+    }
+    if (options.dir.empty()) {
+        options.dir = (std::filesystem::temp_directory_path() / "cfd_reader_benchmark").string();
+    }
+    return options;
+}
+
+void write_json(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot create file: " + path);
+    }
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"format\": \"" << r.format
+            << "\", \"faces\": " << r.faces << ", \"threads\": " << r.threads
+            << ", \"bytes\": " << r.bytes << ", \"real_time_s\": " << r.seconds
+            << ", \"mb_per_second\": " << double(r.bytes) / r.seconds / 1e6
+            << ", \"faces_per_second\": " << double(r.faces) / r.seconds
+            << ", \"peak_rss_bytes\": " << r.peak_rss << ", \"baseline_rss_bytes\": " << r.baseline_rss
+            << ", \"peak_rss_scope\": \"" << (r.per_case_rss ? "case" : "process") << "\"}"
+            << (i + 1 < results.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parse_arguments(argc, argv);
+        std::filesystem::create_directories(options.dir);
+
+        std::printf("%-44s %12s %12s %14s %12s\n", "Benchmark", "Time(ms)", "MB/s", "Mfaces/s",
+                    "PeakRSS(MB)");
+        std::printf("%s\n", std::string(98, '-').c_str());
+
+        std::vector<Result> results;
+        for (size_t faces = options.min_faces; faces <= options.max_faces; faces *= 10) {
+            // Always rewritten: files left by an earlier run may come from an
+            // older writer. The generated mesh is freed before any timing.
+            {
+                const MeshData mesh = generate_sheet(faces);
+                for (const std::string& format : options.formats) {
+                    const std::string path = (std::filesystem::path(options.dir) / file_name(format, faces)).string();
+                    write_format(mesh, format, path);
+                }
+            }
+            for (const std::string& format : options.formats) {
+                const std::string path = (std::filesystem::path(options.dir) / file_name(format, faces)).string();
+                for (const unsigned threads : options.threads) {
+                    const Result r = run_case(path, format, faces, threads, options.repetitions);
+                    std::printf("%-44s %12.2f %12.1f %14.2f %12.1f\n", r.name.c_str(), r.seconds * 1e3,
+                                double(r.bytes) / r.seconds / 1e6, double(r.faces) / r.seconds / 1e6,
+                                double(r.peak_rss) / 1e6);
+                    std::fflush(stdout);
+                    results.push_back(r);
+                }
+            }
+        }
+
+        if (std::any_of(results.begin(), results.end(), [](const Result& r) { return !r.per_case_rss; })) {
+            std::printf("PeakRSS: process-lifetime peak, the high-water mark cannot be reset per case here\n");
+        }
+        if (!options.json_path.empty()) {
+            write_json(options.json_path, results);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "reader_benchmark: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -13,8 +13,8 @@ else:
 # Define the C++ extension module
 sfc_module = Extension(
     'adjacent_faces_cpp',                         # Name of the module in Python
-    ['src/algorithms/adjacent_faces_detector.cpp'], # List of source files
-    include_dirs=[pybind11.get_include()],        # Include directory for Pybind11 headers
+    ['src/algorithms/adjacent_faces_detector.cpp', 'src/mesh_core.cpp'], # List of source files
+    include_dirs=[pybind11.get_include(), 'src'], # Pybind11 and shared mesh_core headers
     language='c++',                               # Language is C++
     extra_compile_args=cpp_args,                  # Pass the platform-specific compile arguments
 )
@@ -5,8 +5,8 @@ import sys
 # 创建C++扩展
 ext_module = Extension(
     'adjacent_faces_cpp',
-    sources=['src/algorithms/adjacent_faces_detector.cpp'],
-    include_dirs=[pybind11.get_include()],
+    sources=['src/algorithms/adjacent_faces_detector.cpp', 'src/mesh_core.cpp'],
+    include_dirs=[pybind11.get_include(), 'src'],
     language='c++',
     extra_compile_args=['/std:c++17', '/O2'] if sys.platform.startswith('win') else ['-std=c++17', '-O3'],
 )
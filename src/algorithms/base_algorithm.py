@@ -21,6 +21,9 @@ class BaseAlgorithm:
         self.mesh_data = mesh_data
         self.vertices = None
         self.faces = None
+        # 共享的mesh_reader_cpp.Mesh句柄；设置后C++检测直接使用它，
+        # 复用其缓存的边表、包围盒等拓扑数据，而不是每次从数组重建
+        self.core_mesh = None
         self.result = {
             'selected_points': [],
             'selected_edges': [],
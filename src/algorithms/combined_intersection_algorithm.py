@@ -68,6 +68,12 @@ class CombinedIntersectionAlgorithm(BaseAlgorithm):
         # 修复：取消缩进，使其成为主要返回路径
         return self.detect_pierced_faces(parent)
     
+    def _pierced_faces_args(self):
+        """pierced_faces_cpp的网格参数：有共享Mesh时传Mesh（复用缓存的包围盒），否则传面片和顶点数组"""
+        if self.core_mesh is not None:
+            return (self.core_mesh,)
+        return (self.faces, self.vertices)
+    
     def detect_pierced_faces(self, parent=None):
         """检测穿刺面"""
         # 只有在 parent 不为 None 时才显示进度对话框
@@ -104,7 +110,7 @@ class CombinedIntersectionAlgorithm(BaseAlgorithm):
                     if hasattr(self, 'enhanced_cpp_available') and self.enhanced_cpp_available:
                         if progress: self.update_progress(15, "使用增强版C++算法(支持相交映射)...")
                         intersecting_faces, intersection_map, detection_time = pierced_faces_cpp.detect_pierced_faces_with_timing(
-                            self.faces, self.vertices)
+                            *self._pierced_faces_args())
                         
                         # 标记使用了增强版C++模块
                         self.used_enhanced_cpp = True
@@ -144,7 +150,7 @@ class CombinedIntersectionAlgorithm(BaseAlgorithm):
                         try:
                             if progress: self.update_progress(15, "尝试使用增强版C++算法...")
                             intersecting_faces, intersection_map, detection_time = pierced_faces_cpp.detect_pierced_faces_with_timing(
-                                self.faces, self.vertices)
+                                *self._pierced_faces_args())
                             
                             # 标记使用了增强版C++模块
                             self.used_enhanced_cpp = True
@@ -187,7 +193,7 @@ class CombinedIntersectionAlgorithm(BaseAlgorithm):
                             detection_time = 0          # 初始化以防 try 块失败
                             try:
                                 # 防止C++模块返回None或其他非预期结果
-                                cpp_result = pierced_faces_cpp.detect_pierced_faces_with_timing(self.faces, self.vertices)
+                                cpp_result = pierced_faces_cpp.detect_pierced_faces_with_timing(*self._pierced_faces_args())
                                 if isinstance(cpp_result, tuple) and len(cpp_result) >= 2:
                                     all_intersecting_faces, detection_time = cpp_result
                                 else:
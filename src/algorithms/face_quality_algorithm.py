@@ -60,8 +60,12 @@ class FaceQualityAlgorithm(BaseAlgorithm):
                 if progress: self.update_progress(10, "使用C++算法分析面片质量...")
                 try:
                     # 调用C++实现
-                    low_quality_faces, stats_dict, detection_time = face_quality_cpp.analyze_face_quality_with_timing(
-                        self.vertices, self.faces, self.threshold)
+                    if self.core_mesh is not None:
+                        low_quality_faces, stats_dict, detection_time = face_quality_cpp.analyze_face_quality_with_timing(
+                            self.core_mesh, self.threshold)
+                    else:
+                        low_quality_faces, stats_dict, detection_time = face_quality_cpp.analyze_face_quality_with_timing(
+                            self.vertices, self.faces, self.threshold)
                     
                     # 保存结果和统计信息
                     self.result['selected_faces'] = low_quality_faces if low_quality_faces is not None else []
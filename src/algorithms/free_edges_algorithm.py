@@ -52,10 +52,15 @@ class FreeEdgesAlgorithm(BaseAlgorithm):
             # 尝试使用C++实现
             if self.use_cpp and HAS_CPP_MODULE:
                 if progress: self.update_progress(10, "使用C++算法检测自由边...")
-                free_edges, detection_time = free_edges_cpp.detect_free_edges_with_timing(self.faces)
-                # 确保 free_edges 是列表
-                if not isinstance(free_edges, list):
-                    free_edges = [] # 或者进行适当的转换
+                if self.core_mesh is not None:
+                    free_edges, detection_time = free_edges_cpp.detect_free_edges_with_timing(self.core_mesh)
+                else:
+                    free_edges, detection_time = free_edges_cpp.detect_free_edges_with_timing(self.faces)
+                # NumPy和Mesh输入返回(n, 2) int32数组，转换为边元组列表
+                if isinstance(free_edges, np.ndarray):
+                    free_edges = [tuple(edge) for edge in free_edges.tolist()]
+                elif not isinstance(free_edges, list):
+                    free_edges = []
                 self.result['selected_edges'] = free_edges
                 
                 total_time = time.time() - start_time
@@ -110,8 +110,14 @@ class MergedVertexDetectionAlgorithm(BaseAlgorithm):
                         print("Warning: overlapping_points_cpp returned unexpected format.")
 
                 elif cpp_module_name == "non_manifold_vertices_cpp" and HAS_NON_MANIFOLD_VERTICES_CPP:
-                    cpp_result = non_manifold_vertices_cpp.detect_non_manifold_vertices_with_timing(
-                        self.vertices, self.faces, self.tolerance)
+                    mesh_args = (self.core_mesh,) if self.core_mesh is not None else (self.vertices, self.faces)
+                    if self.detection_mode == "non_manifold":
+                        # 非流形模式按面片扇区判断：周围面片不止一个扇区或连接非流形边的顶点
+                        cpp_result = non_manifold_vertices_cpp.detect_non_manifold_vertices_fans_with_timing(
+                            *mesh_args)
+                    else:
+                        cpp_result = non_manifold_vertices_cpp.detect_non_manifold_vertices_with_timing(
+                            *mesh_args, self.tolerance)
                     if isinstance(cpp_result, tuple) and len(cpp_result) == 2:
                          result, detection_time = cpp_result
                     else:
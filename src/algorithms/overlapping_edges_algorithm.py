@@ -61,12 +61,16 @@ class OverlappingEdgesAlgorithm(BaseAlgorithm):
             if self.use_cpp and HAS_CPP_MODULE:
                 if progress: self.update_progress(10, "使用C++算法检测重叠边...")
                 
-                # 确保顶点和面片数据是numpy数组
-                vertices_array = np.array(self.vertices, dtype=np.float64)
-                faces_array = np.array(self.faces, dtype=np.int32)
-                
-                overlapping_edges, detection_time = overlapping_edges_cpp.detect_overlapping_edges_with_timing(
-                    vertices_array, faces_array, self.tolerance)
+                if self.core_mesh is not None:
+                    overlapping_edges, detection_time = overlapping_edges_cpp.detect_overlapping_edges_with_timing(
+                        self.core_mesh, self.tolerance)
+                else:
+                    # 确保顶点和面片数据是numpy数组
+                    vertices_array = np.array(self.vertices, dtype=np.float64)
+                    faces_array = np.array(self.faces, dtype=np.int32)
+                    
+                    overlapping_edges, detection_time = overlapping_edges_cpp.detect_overlapping_edges_with_timing(
+                        vertices_array, faces_array, self.tolerance)
                 
                 # C++返回的是原始边数据，我们需要转换为元组列表
                 self.result['selected_edges'] = [tuple(edge) for edge in overlapping_edges]
@@ -168,13 +168,13 @@ def compare_performance(mesh_data):
     
     # 运行C++版本
     print("\n运行C++版本的自由边检测...")
-    cpp_free_edges, cpp_time = free_edges_cpp.detect_free_edges_with_timing(faces.tolist())
+    cpp_free_edges, cpp_time = free_edges_cpp.detect_free_edges_with_timing(faces)
     print(f"C++版本检测到{len(cpp_free_edges)}条自由边")
     print(f"执行时间: {cpp_time:.4f}秒")
     
     # 验证结果一致性
     # 将C++结果转换为Python格式进行比较
-    cpp_edges_set = set(tuple(edge) for edge in cpp_free_edges)
+    cpp_edges_set = set(tuple(edge) for edge in cpp_free_edges.tolist())
     python_edges_set = set(python_free_edges)
     
     if len(cpp_edges_set) == len(python_edges_set) and cpp_edges_set == python_edges_set:
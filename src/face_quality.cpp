@@ -0,0 +1,720 @@
+#include "face_quality.hpp"
+#include "parallel_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define CFD_QUALITY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile the wide kernels for their instruction set only;
+// MSVC accepts the intrinsics without extra flags
+#if defined(CFD_QUALITY_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CFD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CFD_TARGET(isa)
+#endif
+
+namespace cfd {
+
+namespace {
+
+// Faces per parallel chunk
+constexpr size_t kQualityGrain = 1 << 14;
+
+// Faces gathered per block: six float lanes of this length stay in L1
+constexpr size_t kLaneBlock = 256;
+
+// 4 * (1e-10)^2: |n|^2 of a triangle with area 1e-10
+constexpr float kMinNormSq = 4e-20f;
+
+// Edge vectors u = p1 - p0 and v = p2 - p0 of a block of faces. The
+// differences are taken in double, so float32 keeps their relative precision
+// even far from the origin.
+struct EdgeLanes {
+    alignas(64) float ux[kLaneBlock];
+    alignas(64) float uy[kLaneBlock];
+    alignas(64) float uz[kLaneBlock];
+    alignas(64) float vx[kLaneBlock];
+    alignas(64) float vy[kLaneBlock];
+    alignas(64) float vz[kLaneBlock];
+};
+
+void gather_lanes(const Mesh& mesh, size_t first_face, size_t count, EdgeLanes& lanes) {
+    const int32_t* faces = mesh.faces().data() + first_face * 3;
+    const double* x = mesh.x().data();
+    const double* y = mesh.y().data();
+    const double* z = mesh.z().data();
+    for (size_t i = 0; i < count; ++i) {
+        const size_t a = size_t(faces[i * 3]);
+        const size_t b = size_t(faces[i * 3 + 1]);
+        const size_t c = size_t(faces[i * 3 + 2]);
+        lanes.ux[i] = float(x[b] - x[a]);
+        lanes.uy[i] = float(y[b] - y[a]);
+        lanes.uz[i] = float(z[b] - z[a]);
+        lanes.vx[i] = float(x[c] - x[a]);
+        lanes.vy[i] = float(y[c] - y[a]);
+        lanes.vz[i] = float(z[c] - z[a]);
+    }
+}
+
+// 2r/R = 2 * (2A / P) / (abc / 4A) = 16A^2 / (P abc) = 4|n|^2 / (P abc).
+// A zero edge also scores 0: when the compiler fuses the cross product into
+// FMAs, two equal corners leave a rounding residue instead of a zero normal.
+void quality_scalar(const EdgeLanes& l, size_t begin, size_t end, float* out) {
+    for (size_t i = begin; i < end; ++i) {
+        const float wx = l.vx[i] - l.ux[i], wy = l.vy[i] - l.uy[i], wz = l.vz[i] - l.uz[i];
+        const float nx = l.uy[i] * l.vz[i] - l.uz[i] * l.vy[i];
+        const float ny = l.uz[i] * l.vx[i] - l.ux[i] * l.vz[i];
+        const float nz = l.ux[i] * l.vy[i] - l.uy[i] * l.vx[i];
+        const float n2 = nx * nx + ny * ny + nz * nz;
+        const float a = std::sqrt(wx * wx + wy * wy + wz * wz);
+        const float b = std::sqrt(l.vx[i] * l.vx[i] + l.vy[i] * l.vy[i] + l.vz[i] * l.vz[i]);
+        const float c = std::sqrt(l.ux[i] * l.ux[i] + l.uy[i] * l.uy[i] + l.uz[i] * l.uz[i]);
+        const float denominator = (a + b + c) * (a * b * c);
+        out[i] = n2 >= kMinNormSq && denominator > 0.0f ? std::min(1.0f, 4.0f * n2 / denominator) : 0.0f;
+    }
+}
+
+#ifdef CFD_QUALITY_X86
+
+// The last vector of a block runs over the full lane width (the lanes hold
+// kLaneBlock floats) and is stored under a mask, so a face scores the same
+// wherever it sits in a block; the tracker relies on this to match the full
+// pass bit for bit.
+CFD_TARGET("avx2,fma")
+void quality_avx2(const EdgeLanes& l, size_t count, float* out) {
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 min_norm_sq = _mm256_set1_ps(kMinNormSq);
+    const __m256i lane_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t i = 0; i < count; i += 8) {
+        const __m256 ux = _mm256_load_ps(l.ux + i), uy = _mm256_load_ps(l.uy + i),
+                     uz = _mm256_load_ps(l.uz + i);
+        const __m256 vx = _mm256_load_ps(l.vx + i), vy = _mm256_load_ps(l.vy + i),
+                     vz = _mm256_load_ps(l.vz + i);
+        const __m256 wx = _mm256_sub_ps(vx, ux), wy = _mm256_sub_ps(vy, uy),
+                     wz = _mm256_sub_ps(vz, uz);
+        const __m256 nx = _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(uz, vy));
+        const __m256 ny = _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(ux, vz));
+        const __m256 nz = _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(uy, vx));
+        const __m256 n2 = _mm256_fmadd_ps(nx, nx, _mm256_fmadd_ps(ny, ny, _mm256_mul_ps(nz, nz)));
+        const __m256 a = _mm256_sqrt_ps(
+            _mm256_fmadd_ps(wx, wx, _mm256_fmadd_ps(wy, wy, _mm256_mul_ps(wz, wz))));
+        const __m256 b = _mm256_sqrt_ps(
+            _mm256_fmadd_ps(vx, vx, _mm256_fmadd_ps(vy, vy, _mm256_mul_ps(vz, vz))));
+        const __m256 c = _mm256_sqrt_ps(
+            _mm256_fmadd_ps(ux, ux, _mm256_fmadd_ps(uy, uy, _mm256_mul_ps(uz, uz))));
+        const __m256 denominator = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(a, b), c),
+                                                 _mm256_mul_ps(_mm256_mul_ps(a, b), c));
+        const __m256 quality = _mm256_min_ps(one, _mm256_div_ps(_mm256_mul_ps(four, n2), denominator));
+        const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(n2, min_norm_sq, _CMP_GE_OQ),
+                                           _mm256_cmp_ps(denominator, zero, _CMP_GT_OQ));
+        const __m256i store = _mm256_cmpgt_epi32(_mm256_set1_epi32(int(count - i)), lane_index);
+        _mm256_maskstore_ps(out + i, store, _mm256_and_ps(valid, quality));
+    }
+}
+
+// GCC 12 warns about the undefined pass-through operand inside the AVX-512
+// intrinsic headers
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+CFD_TARGET("avx512f")
+void quality_avx512(const EdgeLanes& l, size_t count, float* out) {
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 min_norm_sq = _mm512_set1_ps(kMinNormSq);
+    for (size_t i = 0; i < count; i += 16) {
+        const __m512 ux = _mm512_load_ps(l.ux + i), uy = _mm512_load_ps(l.uy + i),
+                     uz = _mm512_load_ps(l.uz + i);
+        const __m512 vx = _mm512_load_ps(l.vx + i), vy = _mm512_load_ps(l.vy + i),
+                     vz = _mm512_load_ps(l.vz + i);
+        const __m512 wx = _mm512_sub_ps(vx, ux), wy = _mm512_sub_ps(vy, uy),
+                     wz = _mm512_sub_ps(vz, uz);
+        const __m512 nx = _mm512_sub_ps(_mm512_mul_ps(uy, vz), _mm512_mul_ps(uz, vy));
+        const __m512 ny = _mm512_sub_ps(_mm512_mul_ps(uz, vx), _mm512_mul_ps(ux, vz));
+        const __m512 nz = _mm512_sub_ps(_mm512_mul_ps(ux, vy), _mm512_mul_ps(uy, vx));
+        const __m512 n2 = _mm512_fmadd_ps(nx, nx, _mm512_fmadd_ps(ny, ny, _mm512_mul_ps(nz, nz)));
+        const __m512 a = _mm512_sqrt_ps(
+            _mm512_fmadd_ps(wx, wx, _mm512_fmadd_ps(wy, wy, _mm512_mul_ps(wz, wz))));
+        const __m512 b = _mm512_sqrt_ps(
+            _mm512_fmadd_ps(vx, vx, _mm512_fmadd_ps(vy, vy, _mm512_mul_ps(vz, vz))));
+        const __m512 c = _mm512_sqrt_ps(
+            _mm512_fmadd_ps(ux, ux, _mm512_fmadd_ps(uy, uy, _mm512_mul_ps(uz, uz))));
+        const __m512 denominator = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(a, b), c),
+                                                 _mm512_mul_ps(_mm512_mul_ps(a, b), c));
+        const __m512 quality = _mm512_min_ps(one, _mm512_div_ps(_mm512_mul_ps(four, n2), denominator));
+        const __mmask16 valid = _mm512_cmp_ps_mask(n2, min_norm_sq, _CMP_GE_OQ) &
+                                _mm512_cmp_ps_mask(denominator, zero, _CMP_GT_OQ);
+        const __mmask16 store = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+        _mm512_mask_storeu_ps(out + i, store, _mm512_maskz_mov_ps(valid, quality));
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // CFD_QUALITY_X86
+
+SimdLevel detect_simd_level() {
+#if defined(CFD_QUALITY_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#elif defined(CFD_QUALITY_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return SimdLevel::Scalar;
+    }
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!os_saves_ymm) {
+        return SimdLevel::Scalar;
+    }
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) != 0 && (_xgetbv(0) & 0xe6) == 0xe6) {
+        return SimdLevel::AVX512;
+    }
+    if ((info[1] & (1 << 5)) != 0 && fma) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* const kMetricNames[kNumQualityMetrics] = {
+    "quality", "aspect_ratio", "skewness", "min_angle", "max_angle", "area", "edge_ratio", "warpage"};
+
+constexpr double kRadToDeg = 57.29577951308232;
+
+// Area below which a face counts as degenerate
+constexpr double kMinArea = 1e-10;
+
+constexpr uint32_t kAngleMetrics = kMetricSkewness | kMetricMinAngle | kMetricMaxAngle;
+
+// Bits of the requested metrics in record order
+struct RecordLayout {
+    int count = 0;
+    int bits[kNumQualityMetrics];
+
+    explicit RecordLayout(uint32_t metrics) {
+        for (int bit = 0; bit < kNumQualityMetrics; ++bit) {
+            if (metrics & (1u << bit)) {
+                bits[count++] = bit;
+            }
+        }
+    }
+
+    void write(const double (&values)[kNumQualityMetrics], float* record) const {
+        for (int i = 0; i < count; ++i) {
+            record[i] = float(values[bits[i]]);
+        }
+    }
+};
+
+// Fills values (indexed by metric bit) for the triangle p0 p1 p2. The
+// corner angles use atan2(|n|, dot), which stays accurate for needle and
+// cap shaped slivers where acos of a normalized dot product does not.
+void triangle_metrics(const Vector3d& p0, const Vector3d& p1, const Vector3d& p2, uint32_t metrics,
+                      double (&values)[kNumQualityMetrics]) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    const Vector3d e0 = p1 - p0, e1 = p2 - p1, e2 = p0 - p2;
+    const double l0 = e0.norm(), l1 = e1.norm(), l2 = e2.norm();
+    const double lmin = std::min(l0, std::min(l1, l2));
+    const double lmax = std::max(l0, std::max(l1, l2));
+    const double perimeter = l0 + l1 + l2;
+    const double n = e0.cross(p2 - p0).norm();  // Twice the area
+    const bool degenerate = 0.5 * n < kMinArea || lmin == 0.0;
+
+    values[0] = degenerate ? 0.0 : std::min(1.0, 4.0 * n * n / (perimeter * l0 * l1 * l2));
+    values[1] = degenerate ? infinity : lmax * perimeter / (2.0 * std::sqrt(3.0) * n);
+    if (metrics & kAngleMetrics) {
+        double amin = 0.0, amax = 180.0;
+        if (!degenerate) {
+            const double a0 = std::atan2(n, -e0.dot(e2)) * kRadToDeg;
+            const double a1 = std::atan2(n, -e1.dot(e0)) * kRadToDeg;
+            const double a2 = 180.0 - a0 - a1;
+            amin = std::min(a0, std::min(a1, a2));
+            amax = std::max(a0, std::max(a1, a2));
+        }
+        values[2] = std::max((amax - 60.0) / 120.0, (60.0 - amin) / 60.0);
+        values[3] = amin;
+        values[4] = amax;
+    }
+    values[5] = 0.5 * n;
+    values[6] = lmin > 0.0 ? lmax / lmin : infinity;
+    values[7] = 0.0;
+}
+
+// Angle in degrees between the planes of two triangle normals, 0 to 90
+// (0 when either normal is zero). Ignoring the orientation keeps planar
+// concave quads, whose reflex-corner split folds one triangle over, at 0.
+double plane_angle(const Vector3d& a, const Vector3d& b) {
+    return std::atan2(a.cross(b).norm(), std::abs(a.dot(b))) * kRadToDeg;
+}
+
+void quad_corner_metrics(const Vector3d (&p)[4], uint32_t metrics, double (&values)[kNumQualityMetrics]) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    Vector3d e[4];
+    double lmin = infinity, lmax = 0.0, perimeter = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        e[i] = p[(i + 1) % 4] - p[i];
+        const double l = e[i].norm();
+        lmin = std::min(lmin, l);
+        lmax = std::max(lmax, l);
+        perimeter += l;
+    }
+    // Vector area of the quad: half the cross product of its diagonals
+    const Vector3d normal = (p[2] - p[0]).cross(p[3] - p[1]);
+    const double n = normal.norm();
+    const bool degenerate = 0.5 * n < kMinArea || lmin == 0.0;
+
+    values[0] = std::numeric_limits<double>::quiet_NaN();
+    values[1] = degenerate ? infinity : lmax * perimeter / (2.0 * n);
+    if (metrics & kAngleMetrics) {
+        double amin = 0.0, amax = 180.0;
+        if (!degenerate) {
+            const Vector3d unit = normal / n;
+            amin = 360.0;
+            amax = 0.0;
+            for (int i = 0; i < 4; ++i) {
+                // Interior angle from the outgoing to the incoming edge around the
+                // quad normal; corners turning the other way are reflex
+                const Vector3d incoming = e[(i + 3) % 4] * -1.0;
+                double angle = std::atan2(e[i].cross(incoming).dot(unit), e[i].dot(incoming)) * kRadToDeg;
+                if (angle < 0.0) {
+                    angle += 360.0;
+                }
+                amin = std::min(amin, angle);
+                amax = std::max(amax, angle);
+            }
+        }
+        values[2] = std::min(1.0, std::max((amax - 90.0) / 90.0, (90.0 - amin) / 90.0));
+        values[3] = amin;
+        values[4] = amax;
+    }
+    values[5] = 0.5 * n;
+    values[6] = lmin > 0.0 ? lmax / lmin : infinity;
+    if (metrics & kMetricWarpage) {
+        const Vector3d d02 = p[2] - p[0], d13 = p[3] - p[1];
+        values[7] = std::max(plane_angle(e[0].cross(d02), d02.cross(p[3] - p[0])),
+                             plane_angle(e[1].cross(d13), d13.cross(p[0] - p[1])));
+    } else {
+        values[7] = 0.0;
+    }
+}
+
+// Values per parallel chunk of the statistics pass
+constexpr size_t kStatisticsGrain = 1 << 16;
+
+// Histogram and moments of one chunk. Sums are taken relative to the chunk's
+// first finite value, which keeps the sum of squares from cancelling when
+// the spread is small against the magnitude.
+struct ChunkStatistics {
+    std::vector<int64_t> counts;
+    size_t count = 0;
+    size_t finite_count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double mean = 0.0;
+    double m2 = 0.0;  // Sum of squared deviations from the mean
+    std::vector<int32_t> below;
+};
+
+// Same as gather_lanes for the listed faces of caller buffers
+template <typename Real, typename Index>
+void gather_listed_lanes(const Real* xyz, const Index* faces, const int32_t* face_ids, size_t count,
+                         EdgeLanes& lanes) {
+    for (size_t i = 0; i < count; ++i) {
+        const Index* face = faces + size_t(face_ids[i]) * 3;
+        const Real* a = xyz + size_t(face[0]) * 3;
+        const Real* b = xyz + size_t(face[1]) * 3;
+        const Real* c = xyz + size_t(face[2]) * 3;
+        lanes.ux[i] = float(double(b[0]) - double(a[0]));
+        lanes.uy[i] = float(double(b[1]) - double(a[1]));
+        lanes.uz[i] = float(double(b[2]) - double(a[2]));
+        lanes.vx[i] = float(double(c[0]) - double(a[0]));
+        lanes.vy[i] = float(double(c[1]) - double(a[1]));
+        lanes.vz[i] = float(double(c[2]) - double(a[2]));
+    }
+}
+
+using QualityKernel = void (*)(const EdgeLanes&, size_t, float*);
+
+QualityKernel quality_kernel(SimdLevel level) {
+    level = std::min(level, simd_level());
+#ifdef CFD_QUALITY_X86
+    if (level == SimdLevel::AVX512) {
+        return quality_avx512;
+    }
+    if (level == SimdLevel::AVX2) {
+        return quality_avx2;
+    }
+#endif
+    return [](const EdgeLanes& lanes, size_t count, float* out) { quality_scalar(lanes, 0, count, out); };
+}
+
+} // namespace
+
+SimdLevel simd_level() {
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX512:
+        return "avx512";
+    case SimdLevel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void face_quality(const Mesh& mesh, float* out, SimdLevel level, unsigned num_threads) {
+    const QualityKernel kernel = quality_kernel(level);
+    parallel_for(0, mesh.num_faces(), kQualityGrain, [&](size_t begin, size_t end) {
+        EdgeLanes lanes;
+        for (size_t block = begin; block < end; block += kLaneBlock) {
+            const size_t count = std::min(kLaneBlock, end - block);
+            gather_lanes(mesh, block, count, lanes);
+            kernel(lanes, count, out + block);
+        }
+    }, num_threads);
+}
+
+std::vector<float> face_quality(const Mesh& mesh, SimdLevel level) {
+    std::vector<float> quality(mesh.num_faces());
+    face_quality(mesh, quality.data(), level);
+    return quality;
+}
+
+const char* quality_metric_name(int bit) {
+    if (bit < 0 || bit >= kNumQualityMetrics) {
+        throw std::runtime_error("Quality metric bit out of range: " + std::to_string(bit));
+    }
+    return kMetricNames[bit];
+}
+
+QualityMetric quality_metric_from_name(const std::string& name) {
+    for (int bit = 0; bit < kNumQualityMetrics; ++bit) {
+        if (name == kMetricNames[bit]) {
+            return QualityMetric(1u << bit);
+        }
+    }
+    throw std::runtime_error("Unknown quality metric: " + name);
+}
+
+int quality_metric_count(uint32_t metrics) {
+    return RecordLayout(metrics).count;
+}
+
+void face_metrics(const Mesh& mesh, uint32_t metrics, float* out, unsigned num_threads) {
+    const RecordLayout layout(metrics);
+    parallel_for(0, mesh.num_faces(), kQualityGrain, [&](size_t begin, size_t end) {
+        double values[kNumQualityMetrics];
+        for (size_t f = begin; f < end; ++f) {
+            const std::array<int32_t, 3> face = mesh.face(f);
+            triangle_metrics(mesh.vertex(size_t(face[0])), mesh.vertex(size_t(face[1])),
+                             mesh.vertex(size_t(face[2])), metrics, values);
+            layout.write(values, out + f * size_t(layout.count));
+        }
+    }, num_threads);
+}
+
+void quad_metrics(const Mesh& mesh, const int32_t* quads, size_t num_quads, uint32_t metrics,
+                  float* out, unsigned num_threads) {
+    const uint32_t num_vertices = uint32_t(mesh.num_vertices());
+    for (size_t i = 0; i < num_quads * 4; ++i) {
+        if (uint32_t(quads[i]) >= num_vertices) {
+            throw std::runtime_error("Quad " + std::to_string(i / 4) + " references vertex " +
+                                     std::to_string(quads[i]) + " but the mesh has " +
+                                     std::to_string(num_vertices) + " vertices");
+        }
+    }
+    const RecordLayout layout(metrics);
+    parallel_for(0, num_quads, kQualityGrain, [&](size_t begin, size_t end) {
+        double values[kNumQualityMetrics];
+        Vector3d corners[4];
+        for (size_t q = begin; q < end; ++q) {
+            for (int i = 0; i < 4; ++i) {
+                corners[i] = mesh.vertex(size_t(quads[q * 4 + size_t(i)]));
+            }
+            quad_corner_metrics(corners, metrics, values);
+            layout.write(values, out + q * size_t(layout.count));
+        }
+    }, num_threads);
+}
+
+double ValueStatistics::percentile(double p) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    if (p <= 0.0) {
+        return min;
+    }
+    if (p >= 100.0) {
+        return max;
+    }
+    const double target = p / 100.0 * double(count);
+    double seen = 0.0;
+    for (int i = 0; i < bins.count; ++i) {
+        const double in_bin = double(counts[size_t(i)]);
+        if (in_bin > 0.0 && seen + in_bin >= target) {
+            // The end bins also hold the values outside the range (up to the
+            // finite extremes; infinite values are not interpolated)
+            double low = bins.edge(i), high = bins.edge(i + 1);
+            if (i == 0 && std::isfinite(min)) low = std::min(low, min);
+            if (i == bins.count - 1 && std::isfinite(max)) high = std::max(high, max);
+            const double value = low + (high - low) * (target - seen) / in_bin;
+            return std::min(max, std::max(min, value));
+        }
+        seen += in_bin;
+    }
+    return max;
+}
+
+ValueStatistics value_statistics(const float* values, size_t n, const HistogramBins& bins,
+                                 double threshold, unsigned num_threads) {
+    if (bins.count <= 0 || !(bins.upper > bins.lower)) {
+        throw std::runtime_error("Histogram needs at least one bin and upper > lower");
+    }
+    const size_t chunks = parallel_chunk_count(n, kStatisticsGrain, num_threads);
+    std::vector<ChunkStatistics> partial(chunks);
+    parallel_for_chunks(0, n, kStatisticsGrain, [&](size_t chunk, size_t begin, size_t end) {
+        ChunkStatistics& s = partial[chunk];
+        s.counts.assign(size_t(bins.count), 0);
+        double shift = 0.0, sum = 0.0, sum_sq = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            const double v = values[i];
+            if (std::isnan(v)) {
+                continue;
+            }
+            s.counts[size_t(bins.bin(v))]++;
+            s.count++;
+            s.min = std::min(s.min, v);
+            s.max = std::max(s.max, v);
+            if (v < threshold) {
+                s.below.push_back(int32_t(i));
+            }
+            if (std::isfinite(v)) {
+                if (s.finite_count++ == 0) {
+                    shift = v;
+                }
+                sum += v - shift;
+                sum_sq += (v - shift) * (v - shift);
+            }
+        }
+        if (s.finite_count > 0) {
+            const double k = double(s.finite_count);
+            s.mean = shift + sum / k;
+            s.m2 = std::max(0.0, sum_sq - sum * sum / k);
+        }
+    }, num_threads);
+
+    ValueStatistics result;
+    result.bins = bins;
+    result.counts.assign(size_t(bins.count), 0);
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double m2 = 0.0;
+    for (const ChunkStatistics& s : partial) {
+        for (size_t b = 0; b < s.counts.size(); ++b) {
+            result.counts[b] += s.counts[b];
+        }
+        result.count += s.count;
+        min = std::min(min, s.min);
+        max = std::max(max, s.max);
+        if (s.finite_count > 0) {
+            const double na = double(result.finite_count), nb = double(s.finite_count);
+            const double delta = s.mean - result.mean;
+            result.mean += delta * nb / (na + nb);
+            m2 += s.m2 + delta * delta * na * nb / (na + nb);
+            result.finite_count += s.finite_count;
+        }
+        result.below.insert(result.below.end(), s.below.begin(), s.below.end());
+    }
+    if (result.count > 0) {
+        result.min = min;
+        result.max = max;
+    }
+    if (result.finite_count > 0) {
+        result.variance = m2 / double(result.finite_count);
+    }
+    return result;
+}
+
+QualityTracker::QualityTracker(double threshold, const HistogramBins& bins)
+    : threshold_(threshold), bins_(bins), counts_(size_t(std::max(bins.count, 0)), 0) {
+    if (bins.count <= 0 || !(bins.upper > bins.lower)) {
+        throw std::runtime_error("Histogram needs at least one bin and upper > lower");
+    }
+}
+
+void QualityTracker::reset(const Mesh& mesh) {
+    quality_.resize(mesh.num_faces());
+    face_quality(mesh, quality_.data());
+    const ValueStatistics stats = value_statistics(quality_.data(), quality_.size(), bins_, threshold_);
+    counts_ = stats.counts;
+    low_.assign(quality_.size(), 0);
+    for (int32_t f : stats.below) {
+        low_[size_t(f)] = 1;
+    }
+    low_count_ = stats.below.size();
+    const double n = double(stats.finite_count);
+    sum_ = stats.mean * n;
+    sum_sq_ = (stats.variance + stats.mean * stats.mean) * n;
+    min_ = float(stats.min);
+    max_ = float(stats.max);
+    vertex_faces_ = mesh.vertex_faces();
+}
+
+template <typename Real, typename Index>
+QualityTracker::Change QualityTracker::update_faces(const Real* xyz, size_t num_vertices,
+                                                    const Index* faces, size_t num_faces,
+                                                    const int32_t* face_ids, size_t count) {
+    if (num_faces != quality_.size()) {
+        throw std::runtime_error("Face count changed from " + std::to_string(quality_.size()) + " to " +
+                                 std::to_string(num_faces) + " since the quality tracker was reset");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const size_t f = size_t(uint32_t(face_ids[i]));
+        if (f >= num_faces) {
+            throw std::runtime_error("Face id " + std::to_string(face_ids[i]) + " out of range");
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            if (faces[f * 3 + k] < 0 || uint64_t(faces[f * 3 + k]) >= num_vertices) {
+                throw std::runtime_error("Face " + std::to_string(f) + " references vertex " +
+                                         std::to_string(faces[f * 3 + k]) + " but the mesh has " +
+                                         std::to_string(num_vertices) + " vertices");
+            }
+        }
+    }
+
+    // Recompute with the same kernel as the full pass, so a face scores the
+    // same whichever way it was computed
+    std::vector<float> fresh(count);
+    const QualityKernel kernel = quality_kernel(simd_level());
+    parallel_for(0, count, kQualityGrain, [&](size_t begin, size_t end) {
+        EdgeLanes lanes;
+        for (size_t block = begin; block < end; block += kLaneBlock) {
+            const size_t n = std::min(kLaneBlock, end - block);
+            gather_listed_lanes(xyz, faces, face_ids + block, n, lanes);
+            kernel(lanes, n, fresh.data() + block);
+        }
+    });
+
+    Change change;
+    bool extremes_stale = false;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t f = size_t(face_ids[i]);
+        const float old_value = quality_[f];
+        const float value = fresh[i];
+        counts_[size_t(bins_.bin(old_value))]--;
+        counts_[size_t(bins_.bin(value))]++;
+        sum_ += double(value) - double(old_value);
+        sum_sq_ += double(value) * value - double(old_value) * old_value;
+        // Raising the minimum or lowering the maximum needs a rescan
+        extremes_stale |= (old_value <= min_ && value > old_value) || (old_value >= max_ && value < old_value);
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        quality_[f] = value;
+
+        const uint8_t low = value < threshold_ ? 1 : 0;
+        if (low != low_[f]) {
+            low_[f] = low;
+            if (low) {
+                change.added.push_back(int32_t(f));
+                low_count_++;
+            } else {
+                change.removed.push_back(int32_t(f));
+                low_count_--;
+            }
+        }
+    }
+    if (extremes_stale) {
+        refresh_extremes();
+    }
+    std::sort(change.added.begin(), change.added.end());
+    std::sort(change.removed.begin(), change.removed.end());
+    return change;
+}
+
+template QualityTracker::Change QualityTracker::update_faces<float, int32_t>(
+    const float*, size_t, const int32_t*, size_t, const int32_t*, size_t);
+template QualityTracker::Change QualityTracker::update_faces<float, int64_t>(
+    const float*, size_t, const int64_t*, size_t, const int32_t*, size_t);
+template QualityTracker::Change QualityTracker::update_faces<double, int32_t>(
+    const double*, size_t, const int32_t*, size_t, const int32_t*, size_t);
+template QualityTracker::Change QualityTracker::update_faces<double, int64_t>(
+    const double*, size_t, const int64_t*, size_t, const int32_t*, size_t);
+
+std::vector<int32_t> QualityTracker::faces_of_vertices(const int32_t* vertices, size_t count) const {
+    std::vector<int32_t> result;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t v = size_t(uint32_t(vertices[i]));
+        if (v >= vertex_faces_.rows()) {
+            throw std::runtime_error("Vertex id " + std::to_string(vertices[i]) + " out of range");
+        }
+        result.insert(result.end(), vertex_faces_.begin(v), vertex_faces_.end(v));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<int32_t> QualityTracker::low_faces() const {
+    std::vector<int32_t> result;
+    result.reserve(low_count_);
+    for (size_t f = 0; f < low_.size(); ++f) {
+        if (low_[f]) {
+            result.push_back(int32_t(f));
+        }
+    }
+    return result;
+}
+
+ValueStatistics QualityTracker::statistics() const {
+    ValueStatistics stats;
+    stats.bins = bins_;
+    stats.counts = counts_;
+    stats.count = stats.finite_count = quality_.size();
+    if (!quality_.empty()) {
+        const double n = double(quality_.size());
+        stats.min = min_;
+        stats.max = max_;
+        stats.mean = sum_ / n;
+        stats.variance = std::max(0.0, sum_sq_ / n - stats.mean * stats.mean);
+    }
+    return stats;
+}
+
+void QualityTracker::refresh_extremes() {
+    if (quality_.empty()) {
+        return;
+    }
+    const auto extremes = std::minmax_element(quality_.begin(), quality_.end());
+    min_ = *extremes.first;
+    max_ = *extremes.second;
+}
+
+} // namespace cfd
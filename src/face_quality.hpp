@@ -0,0 +1,185 @@
+#ifndef FACE_QUALITY_HPP
+#define FACE_QUALITY_HPP
+
+// Batched triangle quality kernels over a cfd::Mesh. Faces are gathered in
+// blocks into structure-of-arrays float32 lanes (edge vectors relative to the
+// first corner) and evaluated with AVX-512, AVX2 or scalar code, selected at
+// run time from the CPU features.
+//
+// A second, fused pass computes any subset of the per-face metrics used by
+// the solver acceptance checks (aspect ratio, skewness, angles, area, edge
+// ratio, quad warpage) into packed float32 records.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mesh_core.hpp"
+
+namespace cfd {
+
+enum class SimdLevel { Scalar = 0, AVX2 = 1, AVX512 = 2 };
+
+// Widest instruction set supported by both this build and the running CPU
+SimdLevel simd_level();
+
+const char* simd_level_name(SimdLevel level);
+
+// STAR-CCM+ face quality 2r/R (inradius over circumradius, 1 for an
+// equilateral triangle), computed from the cross product as
+// 4|n|^2 / (perimeter * a * b * c). Faces with area below 1e-10 score 0.
+//
+// Writes one value per face to out (mesh.num_faces() floats). level caps the
+// instruction set; levels the CPU lacks fall back to the next lower one.
+void face_quality(const Mesh& mesh, float* out, SimdLevel level = simd_level(),
+                  unsigned num_threads = 0);
+
+std::vector<float> face_quality(const Mesh& mesh, SimdLevel level = simd_level());
+
+// Per-face metrics of the fused quality pass, one bit each. Angles are in
+// degrees.
+enum QualityMetric : uint32_t {
+    kMetricQuality = 1u << 0,      // 2r/R as above (triangles only, NaN for quads)
+    kMetricAspectRatio = 1u << 1,  // Triangles: lmax * P / (4 sqrt(3) A); quads: lmax * P / (4 A)
+    kMetricSkewness = 1u << 2,     // Equiangle skewness: max((amax - e) / (180 - e), (e - amin) / e)
+    kMetricMinAngle = 1u << 3,
+    kMetricMaxAngle = 1u << 4,     // Quads report reflex corners above 180
+    kMetricArea = 1u << 5,
+    kMetricEdgeRatio = 1u << 6,    // Longest over shortest edge
+    kMetricWarpage = 1u << 7,      // Quads: largest angle between the planes of the two
+                                   // triangles of either diagonal split; 0 for triangles
+};
+
+constexpr int kNumQualityMetrics = 8;
+constexpr uint32_t kAllQualityMetrics = (1u << kNumQualityMetrics) - 1;
+
+// Name of metric bit i ("quality", "aspect_ratio", "skewness", "min_angle",
+// "max_angle", "area", "edge_ratio", "warpage") and the reverse lookup,
+// which throws std::runtime_error for unknown names
+const char* quality_metric_name(int bit);
+QualityMetric quality_metric_from_name(const std::string& name);
+
+// Number of metrics selected in the mask
+int quality_metric_count(uint32_t metrics);
+
+// Computes the selected metrics of every triangle in one parallel pass that
+// shares the edge vectors, lengths and cross products between metrics. out
+// holds one record per face of quality_metric_count(metrics) floats, the
+// metrics in bit order. Degenerate faces (area below 1e-10 or a zero edge)
+// get quality 0, angles 0 / 180, skewness 1 and an infinite aspect ratio;
+// the edge ratio is infinite only for a zero edge.
+void face_metrics(const Mesh& mesh, uint32_t metrics, float* out, unsigned num_threads = 0);
+
+// Same for quads given as num_quads row-major index quadruples into the
+// vertices of mesh (the triangles of mesh are ignored). Throws
+// std::runtime_error for indices out of range.
+void quad_metrics(const Mesh& mesh, const int32_t* quads, size_t num_quads, uint32_t metrics,
+                  float* out, unsigned num_threads = 0);
+
+// Equal-width histogram bins over [lower, upper). Values outside the range
+// fall into the first or last bin.
+struct HistogramBins {
+    int count = 10;
+    double lower = 0.0;
+    double upper = 1.0;
+
+    int bin(double value) const {
+        const double position = (value - lower) * double(count) / (upper - lower);
+        return position < 1.0 ? 0 : position >= double(count - 1) ? count - 1 : int(position);
+    }
+
+    double edge(int i) const { return lower + (upper - lower) * double(i) / double(count); }
+};
+
+// Summary of a value array from one parallel pass. NaN values are skipped;
+// infinite values are binned and bound min / max but are left out of the
+// mean and variance.
+struct ValueStatistics {
+    HistogramBins bins;
+    std::vector<int64_t> counts;   // Values per bin
+    size_t count = 0;              // Values binned (all but NaN)
+    size_t finite_count = 0;       // Values in the mean and variance
+    double min = 0.0;              // min / max / mean / variance are 0 when count is 0
+    double max = 0.0;
+    double mean = 0.0;
+    double variance = 0.0;         // Population variance
+    std::vector<int32_t> below;    // Indices of the values below the threshold, ascending
+
+    // p-th percentile (0..100) interpolated linearly inside its bin, so its
+    // error is at most one bin width; 0 and 100 return min and max exactly
+    double percentile(double p) const;
+};
+
+// Each thread fills its own histogram and moments over a contiguous chunk;
+// the chunks are merged at the end (moments with Chan's pairwise update).
+// Values below threshold are also collected (none by default). Throws
+// std::runtime_error for an empty bin count or range.
+ValueStatistics value_statistics(const float* values, size_t n, const HistogramBins& bins,
+                                 double threshold = -std::numeric_limits<double>::infinity(),
+                                 unsigned num_threads = 0);
+
+// Face quality kept across local edits. reset() runs the full SIMD pass;
+// afterwards update_faces() recomputes only the listed faces from the
+// current geometry and adjusts the histogram, the running moments and the
+// set of faces below the threshold in place, so the cost follows the size
+// of the edit rather than of the mesh.
+class QualityTracker {
+public:
+    explicit QualityTracker(double threshold = 0.3, const HistogramBins& bins = HistogramBins());
+
+    // Faces that entered / left the low-quality set in one update, ascending
+    struct Change {
+        std::vector<int32_t> added;
+        std::vector<int32_t> removed;
+    };
+
+    // Full pass over mesh. Keeps its vertex -> face incidence for
+    // faces_of_vertices().
+    void reset(const Mesh& mesh);
+
+    // Recomputes face_ids from row-major (num_vertices x 3) coordinates and
+    // (num_faces x 3) indices, typically the caller's arrays after the edit.
+    // Instantiated for float / double coordinates and int32 / int64 indices.
+    // Throws std::runtime_error when the face count differs from the last
+    // reset() (connectivity edits that add or remove faces need a reset) or
+    // for indices out of range.
+    template <typename Real, typename Index>
+    Change update_faces(const Real* xyz, size_t num_vertices, const Index* faces, size_t num_faces,
+                        const int32_t* face_ids, size_t count);
+
+    // Faces around the given vertices, sorted and unique, from the
+    // connectivity of the last reset()
+    std::vector<int32_t> faces_of_vertices(const int32_t* vertices, size_t count) const;
+
+    double threshold() const { return threshold_; }
+    size_t num_faces() const { return quality_.size(); }
+    const std::vector<float>& quality() const { return quality_; }
+    const std::vector<int64_t>& counts() const { return counts_; }
+    size_t low_count() const { return low_count_; }
+    std::vector<int32_t> low_faces() const;
+
+    // Histogram, min / max / mean / variance of the current values in the
+    // form of value_statistics() (without the below list)
+    ValueStatistics statistics() const;
+
+private:
+    void refresh_extremes();
+
+    double threshold_;
+    HistogramBins bins_;
+    std::vector<float> quality_;
+    std::vector<uint8_t> low_;
+    std::vector<int64_t> counts_;
+    size_t low_count_ = 0;
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+    float min_ = 0.0f;
+    float max_ = 0.0f;
+    Incidence vertex_faces_;
+};
+
+} // namespace cfd
+
+#endif // FACE_QUALITY_HPP
@@ -7,181 +7,402 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <vector>
-#include <unordered_map>
 #include <string>
 #include <cmath>
+#include <cstdio>
+#include <limits>
+#include <utility>
 #include <chrono>
 #include <iostream>
 #include <algorithm>
+#include <stdexcept>
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
+#include "face_quality.hpp"
 
 namespace py = pybind11;
 
 /**
- * 计算单个三角形面片的质量
+ * 计算所有面片的质量，返回float32数组
  * 使用STAR-CCM+的质量度量: quality = 2 * (r/R)
  * 其中r是内接圆半径，R是外接圆半径
+ * 面片按块收集成SoA的float32通道，由AVX-512/AVX2/标量内核批量计算（见face_quality.hpp）
  */
-float calculate_face_quality(const std::vector<std::vector<float>>& vertices) {
-    // 获取三个顶点
-    const auto& v1 = vertices[0];
-    const auto& v2 = vertices[1];
-    const auto& v3 = vertices[2];
-    
-    // 计算三条边的长度
-    float a = std::sqrt(std::pow(v2[0]-v3[0], 2) + std::pow(v2[1]-v3[1], 2) + std::pow(v2[2]-v3[2], 2));
-    float b = std::sqrt(std::pow(v1[0]-v3[0], 2) + std::pow(v1[1]-v3[1], 2) + std::pow(v1[2]-v3[2], 2));
-    float c = std::sqrt(std::pow(v1[0]-v2[0], 2) + std::pow(v1[1]-v2[1], 2) + std::pow(v1[2]-v2[2], 2));
-    
-    // 计算半周长
-    float s = (a + b + c) / 2.0f;
-    
-    // 计算面积（使用海伦公式）
-    float area = std::sqrt(std::max(0.0f, s * (s - a) * (s - b) * (s - c)));
-    
-    // 处理退化三角形
-    if (area < 1e-10f) {
-        return 0.0f;
+py::array_t<float> compute_face_quality(const cfd::Mesh& mesh) {
+    py::array_t<float> quality(py::ssize_t(mesh.num_faces()));
+    float* out = quality.mutable_data();
+    {
+        py::gil_scoped_release release;
+        cfd::face_quality(mesh, out);
     }
-    
-    // 计算内接圆半径
-    float r = area / s;
-    
-    // 计算外接圆半径
-    float R = (a * b * c) / (4.0f * area);
-    
-    // 计算STAR-CCM+质量度量
-    float quality = std::min(1.0f, std::max(0.0f, 2.0f * (r / R)));
-    
     return quality;
 }
 
+py::array_t<float> compute_face_quality_from_arrays(const py::array& vertices_array,
+                                                    const py::array& faces_array) {
+    return compute_face_quality(cfd::mesh_from_arrays(vertices_array, faces_array));
+}
+
+/**
+ * 指标名称列表转换为位掩码，None表示default_metrics
+ */
+uint32_t metric_mask(const py::object& metrics, uint32_t default_metrics) {
+    if (metrics.is_none()) {
+        return default_metrics;
+    }
+    uint32_t mask = 0;
+    for (const auto& name : metrics) {
+        mask |= cfd::quality_metric_from_name(py::cast<std::string>(name));
+    }
+    if (mask == 0) {
+        throw std::runtime_error("At least one quality metric must be requested");
+    }
+    return mask;
+}
+
+/**
+ * 创建count条记录的NumPy结构化数组，每个请求的指标是一个float32字段，
+ * 字段按位顺序紧密排列，fill直接写入记录缓冲区
+ */
+template <typename Fill>
+py::array metric_records(size_t count, uint32_t metrics, Fill fill) {
+    py::list names, formats, offsets;
+    py::ssize_t itemsize = 0;
+    for (int bit = 0; bit < cfd::kNumQualityMetrics; ++bit) {
+        if (metrics & (1u << bit)) {
+            names.append(cfd::quality_metric_name(bit));
+            formats.append("<f4");
+            offsets.append(itemsize);
+            itemsize += py::ssize_t(sizeof(float));
+        }
+    }
+    py::array records(py::dtype(names, formats, offsets, itemsize),
+                      std::vector<py::ssize_t>{py::ssize_t(count)});
+    float* out = static_cast<float*>(records.mutable_data());
+    {
+        py::gil_scoped_release release;
+        fill(out);
+    }
+    return records;
+}
+
+/**
+ * 一次并行遍历计算三角形面片的多项质量指标，返回结构化数组
+ * 默认计算除翘曲（三角形恒为0）以外的全部指标
+ */
+py::array compute_face_metrics(const cfd::Mesh& mesh, const py::object& metrics) {
+    const uint32_t mask = metric_mask(metrics, cfd::kAllQualityMetrics & ~cfd::kMetricWarpage);
+    return metric_records(mesh.num_faces(), mask, [&](float* out) {
+        cfd::face_metrics(mesh, mask, out);
+    });
+}
+
+py::array compute_face_metrics_from_arrays(const py::array& vertices_array,
+                                           const py::array& faces_array,
+                                           const py::object& metrics) {
+    return compute_face_metrics(cfd::mesh_from_arrays(vertices_array, faces_array), metrics);
+}
+
+/**
+ * 四边形面片（如MeshData.quads）的质量指标，quads为(k, 4)顶点索引数组
+ * 默认计算除2r/R（只对三角形定义）以外的全部指标
+ */
+py::array compute_quad_metrics(const cfd::Mesh& mesh, const py::array& quads_array,
+                               const py::object& metrics) {
+    if (quads_array.ndim() != 2 || quads_array.shape(1) != 4) {
+        throw std::runtime_error("Quads array must be a 2D array with shape (k, 4)");
+    }
+    auto quads = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(quads_array);
+    if (!quads) throw py::error_already_set();
+    const uint32_t mask = metric_mask(metrics, cfd::kAllQualityMetrics & ~cfd::kMetricQuality);
+    const size_t num_quads = size_t(quads_array.shape(0));
+    return metric_records(num_quads, mask, [&](float* out) {
+        cfd::quad_metrics(mesh, quads.data(), num_quads, mask, out);
+    });
+}
+
+py::array compute_quad_metrics_from_arrays(const py::array& vertices_array,
+                                           const py::array& quads_array,
+                                           const py::object& metrics) {
+    const py::array_t<int32_t> no_faces(std::vector<py::ssize_t>{0, 3});
+    return compute_quad_metrics(cfd::mesh_from_arrays(vertices_array, no_faces), quads_array, metrics);
+}
+
+/**
+ * 统计结果转换为Python字典：直方图计数和分箱边界为NumPy数组，
+ * percentiles中的每个百分位数由直方图插值得到
+ */
+py::dict statistics_to_dict(const cfd::ValueStatistics& stats, const std::vector<double>& percentiles) {
+    std::vector<double> edges(size_t(stats.bins.count) + 1);
+    for (int i = 0; i <= stats.bins.count; ++i) {
+        edges[size_t(i)] = stats.bins.edge(i);
+    }
+    std::vector<double> values;
+    for (double p : percentiles) {
+        values.push_back(stats.percentile(p));
+    }
+    py::dict result;
+    result["count"] = stats.count;
+    result["min"] = stats.min;
+    result["max"] = stats.max;
+    result["mean"] = stats.mean;
+    result["variance"] = stats.variance;
+    result["std"] = std::sqrt(stats.variance);
+    result["counts"] = cfd::copy_to_array(stats.counts);
+    result["edges"] = cfd::copy_to_array(edges);
+    result["percentiles"] = cfd::copy_to_array(percentiles);
+    result["percentile_values"] = cfd::copy_to_array(values);
+    result["below"] = cfd::copy_to_array(stats.below);
+    return result;
+}
+
+/**
+ * 任意数值数组（如质量值或某项质量指标）的直方图与统计量，一次并行遍历完成
+ * threshold不为None时，below给出小于阈值的元素下标
+ */
+py::dict quality_statistics(const py::array& values_array, int bins, std::pair<double, double> range,
+                            const std::vector<double>& percentiles, const py::object& threshold) {
+    auto values = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(values_array);
+    if (!values) throw py::error_already_set();
+    const cfd::HistogramBins histogram{bins, range.first, range.second};
+    const double below = threshold.is_none() ? -std::numeric_limits<double>::infinity()
+                                             : py::cast<double>(threshold);
+    cfd::ValueStatistics stats;
+    {
+        py::gil_scoped_release release;
+        stats = cfd::value_statistics(values.data(), size_t(values.size()), histogram, below);
+    }
+    return statistics_to_dict(stats, percentiles);
+}
+
 /**
  * 分析所有面片质量并返回低质量面片的索引
+ * 质量分布、最小/最大/平均值和低质量面片在同一次并行遍历中得到
  */
-std::tuple<std::vector<int>, std::unordered_map<std::string, py::object>, double> 
-analyze_face_quality_with_timing(const py::array_t<float>& vertices_array, 
-                               const py::array_t<int>& faces_array,
-                               float threshold = 0.3f) {
+std::tuple<std::vector<int32_t>, py::dict, double>
+analyze_face_quality_mesh_with_timing(const cfd::Mesh& mesh,
+                                      float threshold = 0.3f) {
     // 记录开始时间
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    // 转换输入数组为C++类型
-    auto vertices_buffer = vertices_array.unchecked<2>();
-    auto faces_buffer = faces_array.unchecked<2>();
-    
-    // 获取顶点和面片数量
-    py::ssize_t num_vertices = vertices_buffer.shape(0);
-    py::ssize_t num_faces = faces_buffer.shape(0);
-    
-    // 结果容器
-    std::vector<int> low_quality_faces;
-    std::vector<float> quality_values;
-    quality_values.reserve(num_faces);
-    
-    // 质量分布统计
-    std::unordered_map<std::string, int> quality_distribution;
-    quality_distribution["0.0-0.1"] = 0;
-    quality_distribution["0.1-0.2"] = 0;
-    quality_distribution["0.2-0.3"] = 0;
-    quality_distribution["0.3-0.4"] = 0;
-    quality_distribution["0.4-0.5"] = 0;
-    quality_distribution["0.5-0.6"] = 0;
-    quality_distribution["0.6-0.7"] = 0;
-    quality_distribution["0.7-0.8"] = 0;
-    quality_distribution["0.8-0.9"] = 0;
-    quality_distribution["0.9-1.0"] = 0;
-    
-    // 分析每个面片
-    for (py::ssize_t i = 0; i < num_faces; ++i) {
-        // 获取面片的三个顶点索引
-        int v1_idx = faces_buffer(i, 0);
-        int v2_idx = faces_buffer(i, 1);
-        int v3_idx = faces_buffer(i, 2);
-        
-        // 获取顶点坐标
-        std::vector<std::vector<float>> face_vertices = {
-            {vertices_buffer(v1_idx, 0), vertices_buffer(v1_idx, 1), vertices_buffer(v1_idx, 2)},
-            {vertices_buffer(v2_idx, 0), vertices_buffer(v2_idx, 1), vertices_buffer(v2_idx, 2)},
-            {vertices_buffer(v3_idx, 0), vertices_buffer(v3_idx, 1), vertices_buffer(v3_idx, 2)}
-        };
-        
-        // 计算面片质量
-        float quality = calculate_face_quality(face_vertices);
-        quality_values.push_back(quality);
-        
-        // 更新质量分布
-        if (quality < 0.1f) {
-            quality_distribution["0.0-0.1"] += 1;
-        } else if (quality < 0.2f) {
-            quality_distribution["0.1-0.2"] += 1;
-        } else if (quality < 0.3f) {
-            quality_distribution["0.2-0.3"] += 1;
-        } else if (quality < 0.4f) {
-            quality_distribution["0.3-0.4"] += 1;
-        } else if (quality < 0.5f) {
-            quality_distribution["0.4-0.5"] += 1;
-        } else if (quality < 0.6f) {
-            quality_distribution["0.5-0.6"] += 1;
-        } else if (quality < 0.7f) {
-            quality_distribution["0.6-0.7"] += 1;
-        } else if (quality < 0.8f) {
-            quality_distribution["0.7-0.8"] += 1;
-        } else if (quality < 0.9f) {
-            quality_distribution["0.8-0.9"] += 1;
-        } else {
-            quality_distribution["0.9-1.0"] += 1;
-        }
-        
-        // 检查是否低于阈值
-        if (quality < threshold) {
-            low_quality_faces.push_back(i);
-        }
+    // 批量计算所有面片的质量，再统计10个分箱的质量分布。分箱边界按double
+    // 比较：恰好等于0.7f（0.69999999）或0.9f（0.89999998）的质量落在下一档
+    // 较低的分箱，以前与float字面量0.7f/0.9f比较时落在较高的分箱，其余值不变
+    cfd::ValueStatistics quality_stats;
+    {
+        py::gil_scoped_release release;
+        const std::vector<float> quality_values = cfd::face_quality(mesh);
+        quality_stats = cfd::value_statistics(quality_values.data(), quality_values.size(),
+                                              cfd::HistogramBins{10, 0.0, 1.0}, threshold);
     }
     
-    // 计算总体统计信息
-    float min_quality = 1.0f;
-    float max_quality = 0.0f;
-    float avg_quality = 0.0f;
-    
-    if (!quality_values.empty()) {
-        min_quality = *std::min_element(quality_values.begin(), quality_values.end());
-        max_quality = *std::max_element(quality_values.begin(), quality_values.end());
-        
-        float sum = 0.0f;
-        for (float q : quality_values) {
-            sum += q;
-        }
-        avg_quality = sum / quality_values.size();
+    // 质量分布，键为"0.0-0.1"形式的区间，按区间顺序排列
+    py::dict quality_distribution;
+    for (int i = 0; i < quality_stats.bins.count; ++i) {
+        char label[32];
+        std::snprintf(label, sizeof(label), "%.1f-%.1f", quality_stats.bins.edge(i),
+                      quality_stats.bins.edge(i + 1));
+        quality_distribution[label] = quality_stats.counts[size_t(i)];
     }
     
-    // 统计结果
-    std::unordered_map<std::string, py::object> stats;
-    stats["total_faces"] = py::cast(num_faces);
-    stats["low_quality_faces"] = py::cast(low_quality_faces);
-    stats["min_quality"] = py::cast(min_quality);
-    stats["max_quality"] = py::cast(max_quality);
-    stats["avg_quality"] = py::cast(avg_quality);
-    
-    // 转换质量分布为Python对象
-    std::unordered_map<std::string, py::object> py_quality_distribution;
-    for (const auto& kv : quality_distribution) {
-        py_quality_distribution[kv.first] = py::cast(kv.second);
-    }
-    stats["quality_distribution"] = py::cast(py_quality_distribution);
+    // 统计结果（没有面片时最小值为1、最大值为0，与之前一致）
+    const bool empty = quality_stats.count == 0;
+    py::dict stats;
+    stats["total_faces"] = py::ssize_t(mesh.num_faces());
+    stats["low_quality_faces"] = quality_stats.below;
+    stats["min_quality"] = empty ? 1.0f : float(quality_stats.min);
+    stats["max_quality"] = empty ? 0.0f : float(quality_stats.max);
+    stats["avg_quality"] = float(quality_stats.mean);
+    stats["quality_distribution"] = quality_distribution;
     
     // 计算执行时间
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end_time - start_time;
     double execution_time = elapsed.count();
     
-    return std::make_tuple(low_quality_faces, stats, execution_time);
+    return std::make_tuple(quality_stats.below, stats, execution_time);
+}
+
+std::tuple<std::vector<int32_t>, py::dict, double>
+analyze_face_quality_with_timing(const py::array& vertices_array, 
+                               const py::array& faces_array,
+                               float threshold = 0.3f) {
+    // 转换输入数组为网格
+    return analyze_face_quality_mesh_with_timing(cfd::mesh_from_arrays(vertices_array, faces_array),
+                                                 threshold);
+}
+
+/**
+ * 按面片数组的类型调用update_faces，int32/int64索引原地读取
+ */
+template <typename Real>
+cfd::QualityTracker::Change update_tracker_typed(cfd::QualityTracker& tracker, const Real* xyz,
+                                                 size_t num_vertices, const py::array& faces_array,
+                                                 const std::vector<int32_t>& face_ids) {
+    const size_t num_faces = size_t(faces_array.shape(0));
+    if (py::isinstance<py::array_t<int64_t>>(faces_array)) {
+        auto faces = py::array_t<int64_t, py::array::c_style | py::array::forcecast>::ensure(faces_array);
+        if (!faces) throw py::error_already_set();
+        py::gil_scoped_release release;
+        return tracker.update_faces(xyz, num_vertices, faces.data(), num_faces, face_ids.data(),
+                                    face_ids.size());
+    }
+    auto faces = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(faces_array);
+    if (!faces) throw py::error_already_set();
+    py::gil_scoped_release release;
+    return tracker.update_faces(xyz, num_vertices, faces.data(), num_faces, face_ids.data(),
+                                face_ids.size());
+}
+
+/**
+ * 局部修改后更新质量：重新计算face_ids以及vertex_ids周围的面片
+ * （两者都为None时重新计算全部面片），返回更新的面片和进出低质量集合的面片
+ */
+py::dict update_quality_tracker(cfd::QualityTracker& tracker, const py::array& vertices_array,
+                                const py::array& faces_array, const py::object& face_ids,
+                                const py::object& vertex_ids) {
+    cfd::detail::check_rows_of_3(vertices_array, "Vertices");
+    cfd::detail::check_rows_of_3(faces_array, "Faces");
+
+    std::vector<int32_t> ids;
+    if (face_ids.is_none() && vertex_ids.is_none()) {
+        ids.resize(size_t(faces_array.shape(0)));
+        for (size_t f = 0; f < ids.size(); ++f) {
+            ids[f] = int32_t(f);
+        }
+    }
+    if (!face_ids.is_none()) {
+        auto listed = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(face_ids);
+        if (!listed) throw py::error_already_set();
+        ids.assign(listed.data(), listed.data() + listed.size());
+    }
+    if (!vertex_ids.is_none()) {
+        auto vertices = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(vertex_ids);
+        if (!vertices) throw py::error_already_set();
+        const std::vector<int32_t> around = tracker.faces_of_vertices(vertices.data(), size_t(vertices.size()));
+        ids.insert(ids.end(), around.begin(), around.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    const size_t num_vertices = size_t(vertices_array.shape(0));
+    cfd::QualityTracker::Change change;
+    if (py::isinstance<py::array_t<float>>(vertices_array)) {
+        auto vertices = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(vertices_array);
+        if (!vertices) throw py::error_already_set();
+        change = update_tracker_typed(tracker, vertices.data(), num_vertices, faces_array, ids);
+    } else {
+        auto vertices = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(vertices_array);
+        if (!vertices) throw py::error_already_set();
+        change = update_tracker_typed(tracker, vertices.data(), num_vertices, faces_array, ids);
+    }
+
+    py::dict result;
+    result["updated"] = cfd::copy_to_array(ids);
+    result["added"] = cfd::copy_to_array(change.added);
+    result["removed"] = cfd::copy_to_array(change.removed);
+    return result;
 }
 
 // 模块定义
 PYBIND11_MODULE(face_quality_cpp, m) {
     m.doc() = "C++ implementation of face quality analysis";
     
+    // 传入mesh_reader_cpp.Mesh时直接使用共享的网格
+    m.def("analyze_face_quality_with_timing", &analyze_face_quality_mesh_with_timing,
+          "Analyze face quality of a shared Mesh",
+          py::arg("mesh"), py::arg("threshold") = 0.3f);
+    
     m.def("analyze_face_quality_with_timing", &analyze_face_quality_with_timing,
           "Analyze face quality and return low quality face indices, statistics and execution time",
           py::arg("vertices"), py::arg("faces"), py::arg("threshold") = 0.3f);
+    
+    // 每个面片的质量值（float32数组）
+    m.def("compute_face_quality", &compute_face_quality,
+          "Quality 2r/R of every face of a shared Mesh as a float32 array",
+          py::arg("mesh"));
+    m.def("compute_face_quality", &compute_face_quality_from_arrays,
+          "Quality 2r/R of every face as a float32 array",
+          py::arg("vertices"), py::arg("faces"));
+    
+    // 多指标质量分析，metrics为指标名称列表，返回结构化数组
+    m.def("compute_face_metrics", &compute_face_metrics,
+          "Selected quality metrics of every triangle of a shared Mesh as a record array",
+          py::arg("mesh"), py::arg("metrics") = py::none());
+    m.def("compute_face_metrics", &compute_face_metrics_from_arrays,
+          "Selected quality metrics of every triangle as a record array",
+          py::arg("vertices"), py::arg("faces"), py::arg("metrics") = py::none());
+    m.def("compute_quad_metrics", &compute_quad_metrics,
+          "Selected quality metrics of (k, 4) quads over the vertices of a shared Mesh",
+          py::arg("mesh"), py::arg("quads"), py::arg("metrics") = py::none());
+    m.def("compute_quad_metrics", &compute_quad_metrics_from_arrays,
+          "Selected quality metrics of (k, 4) quads as a record array",
+          py::arg("vertices"), py::arg("quads"), py::arg("metrics") = py::none());
+    
+    // 直方图与统计量：计数和分箱边界以NumPy数组返回
+    m.def("quality_statistics", &quality_statistics,
+          "Fixed-bin histogram, min / max / mean / variance and histogram percentiles of a value "
+          "array in one parallel pass; 'below' lists the indices under threshold",
+          py::arg("values"), py::arg("bins") = 10,
+          py::arg("range") = std::make_pair(0.0, 1.0),
+          py::arg("percentiles") = std::vector<double>{5.0, 25.0, 50.0, 75.0, 95.0},
+          py::arg("threshold") = py::none());
+    
+    // 质量内核实际使用的指令集："avx512"、"avx2"或"scalar"
+    m.def("simd_level", []() { return std::string(cfd::simd_level_name(cfd::simd_level())); },
+          "Instruction set used by the face quality kernels");
+    
+    // 增量质量分析：保存每个面片的质量、直方图和低质量面片集合，
+    // 局部修改后只重新计算受影响的面片
+    py::class_<cfd::QualityTracker>(m, "QualityTracker")
+        .def(py::init([](const cfd::Mesh& mesh, double threshold, int bins, std::pair<double, double> range) {
+                 cfd::QualityTracker tracker(threshold, cfd::HistogramBins{bins, range.first, range.second});
+                 py::gil_scoped_release release;
+                 tracker.reset(mesh);
+                 return tracker;
+             }),
+             py::arg("mesh"), py::arg("threshold") = 0.3, py::arg("bins") = 10,
+             py::arg("range") = std::make_pair(0.0, 1.0))
+        .def(py::init([](const py::array& vertices, const py::array& faces, double threshold, int bins,
+                         std::pair<double, double> range) {
+                 const cfd::Mesh mesh = cfd::mesh_from_arrays(vertices, faces);
+                 cfd::QualityTracker tracker(threshold, cfd::HistogramBins{bins, range.first, range.second});
+                 py::gil_scoped_release release;
+                 tracker.reset(mesh);
+                 return tracker;
+             }),
+             py::arg("vertices"), py::arg("faces"), py::arg("threshold") = 0.3, py::arg("bins") = 10,
+             py::arg("range") = std::make_pair(0.0, 1.0))
+        .def("reset", &cfd::QualityTracker::reset,
+             "Recompute every face, e.g. after faces were added or removed",
+             py::arg("mesh"), py::call_guard<py::gil_scoped_release>())
+        .def("reset", [](cfd::QualityTracker& tracker, const py::array& vertices, const py::array& faces) {
+                 const cfd::Mesh mesh = cfd::mesh_from_arrays(vertices, faces);
+                 py::gil_scoped_release release;
+                 tracker.reset(mesh);
+             },
+             "Recompute every face, e.g. after faces were added or removed",
+             py::arg("vertices"), py::arg("faces"))
+        .def("update", &update_quality_tracker,
+             "Recompute face_ids and the faces around vertex_ids from the edited (n, 3) vertices and "
+             "(m, 3) faces; returns the updated faces and the faces added to / removed from the "
+             "low-quality set",
+             py::arg("vertices"), py::arg("faces"), py::arg("face_ids") = py::none(),
+             py::arg("vertex_ids") = py::none())
+        .def_property_readonly("threshold", &cfd::QualityTracker::threshold)
+        .def_property_readonly("num_faces", &cfd::QualityTracker::num_faces)
+        .def_property_readonly("low_count", &cfd::QualityTracker::low_count)
+        .def_property_readonly("quality", [](const cfd::QualityTracker& tracker) {
+            return cfd::copy_to_array(tracker.quality());
+        }, "Copy of the per-face quality as a float32 array")
+        .def_property_readonly("counts", [](const cfd::QualityTracker& tracker) {
+            return cfd::copy_to_array(tracker.counts());
+        })
+        .def("low_faces", [](const cfd::QualityTracker& tracker) {
+            return cfd::copy_to_array(tracker.low_faces());
+        }, "Faces below the threshold, ascending")
+        .def("statistics", [](const cfd::QualityTracker& tracker, const std::vector<double>& percentiles) {
+            return statistics_to_dict(tracker.statistics(), percentiles);
+        }, "Histogram and statistics of the current values in the form of quality_statistics()",
+             py::arg("percentiles") = std::vector<double>{5.0, 25.0, 50.0, 75.0, 95.0});
 } 
\ No newline at end of file
@@ -1,53 +1,68 @@
 #include <vector>
-#include <unordered_map>
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
 
 namespace py = pybind11;
 
-// EdgeHash - hash structure for edges
-struct EdgeHash {
-    size_t operator()(const std::pair<int, int>& edge) const {
-        return std::hash<int>()(edge.first) ^ std::hash<int>()(edge.second);
+// There is no vertex count to check against here, but an index must still
+// be non-negative and fit in int32: a wrapped one would silently join edges
+// of unrelated vertices. first_face numbers the faces in the message.
+template <typename Index>
+void check_face_indices(const Index* indices, size_t count, size_t first_face = 0) {
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t index = int64_t(indices[i]);
+        if (index < 0 || index > int64_t(std::numeric_limits<int32_t>::max())) {
+            throw std::runtime_error("Face " + std::to_string(first_face + i / 3) +
+                                     " references invalid vertex index " + std::to_string(index));
+        }
     }
-};
+}
 
-// Free edge detection function - C++ implementation
-std::vector<std::pair<int, int>> detect_free_edges_cpp(
-    const std::vector<std::vector<int>>& faces) {
-    
-    // Map to count occurrences of each edge
-    std::unordered_map<std::pair<int, int>, int, EdgeHash> edge_count;
-    
-    // Process all faces to collect edge information
-    for (const auto& face : faces) {
-        // For triangular faces, process three edges
+// Flattens a list of faces into index triples; faces with more than three
+// indices contribute their first three, shorter ones are skipped. The used
+// indices are checked like those of the NumPy path.
+std::vector<int32_t> flatten_faces(const std::vector<std::vector<int>>& faces) {
+    std::vector<int32_t> flat;
+    flat.reserve(faces.size() * 3);
+    for (size_t f = 0; f < faces.size(); ++f) {
+        const auto& face = faces[f];
         if (face.size() >= 3) {
-            // Get three edges (ensure smaller vertex index is first)
-            std::pair<int, int> edge1 = {std::min(face[0], face[1]), std::max(face[0], face[1])};
-            std::pair<int, int> edge2 = {std::min(face[1], face[2]), std::max(face[1], face[2])};
-            std::pair<int, int> edge3 = {std::min(face[2], face[0]), std::max(face[2], face[0])};
-            
-            // Update edge counts
-            edge_count[edge1]++;
-            edge_count[edge2]++;
-            edge_count[edge3]++;
+            check_face_indices(face.data(), 3, f);
+            flat.insert(flat.end(), face.begin(), face.begin() + 3);
         }
     }
-    
-    // Find edges that appear only once (free edges)
-    std::vector<std::pair<int, int>> free_edges;
-    for (const auto& edge_pair : edge_count) {
-        if (edge_pair.second == 1) {
-            free_edges.push_back(edge_pair.first);
-        }
+    return flat;
+}
+
+// (min, max) vertex pairs of the given edge ids, ascending
+std::vector<std::pair<int, int>> edge_pairs(const cfd::EdgeTopology& topology,
+                                            const std::vector<int32_t>& edge_ids) {
+    std::vector<std::pair<int, int>> pairs;
+    pairs.reserve(edge_ids.size());
+    for (int32_t e : edge_ids) {
+        pairs.emplace_back(cfd::edge_key_first(topology.keys[size_t(e)]),
+                           cfd::edge_key_second(topology.keys[size_t(e)]));
     }
-    
-    return free_edges;
+    return pairs;
+}
+
+// Free edge detection function - C++ implementation
+// Edges are grouped by the radix-sorted edge table of mesh_core; free edges
+// are the groups with a single face
+std::vector<std::pair<int, int>> detect_free_edges_cpp(
+    const std::vector<std::vector<int>>& faces) {
+    const std::vector<int32_t> flat = flatten_faces(faces);
+    const cfd::EdgeTopology topology = cfd::build_edge_topology(flat.data(), flat.size() / 3);
+    return edge_pairs(topology, cfd::free_edges(topology));
 }
 
 // Free edge detection function with timing
@@ -67,10 +82,179 @@ std::pair<std::vector<std::pair<int, int>>, double> detect_free_edges_with_timin
     return {free_edges, duration};
 }
 
+// NumPy path: faces are read in place from a C-contiguous int32 (F, 3)
+// array (other dtypes are widened to int64, checked and narrowed once) and
+// edges come back as an (n, 2) int32 array, avoiding a Python object per
+// face and per edge. The overloads take a generic py::array so that any
+// NumPy array, int64 included, picks them over the nested-list overload.
+using FaceArray = py::array_t<int32_t, py::array::c_style | py::array::forcecast>;
+using WideFaceArray = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+
+// Edge table of an (F, 3) face array, built with the GIL released
+cfd::EdgeTopology topology_from_array(const py::array& array) {
+    if (array.ndim() != 2 || array.shape(1) != 3) {
+        throw std::runtime_error("Faces array must be a 2D array with shape (n, 3)");
+    }
+    const size_t num_faces = size_t(array.shape(0));
+    if (py::isinstance<py::array_t<int32_t>>(array)) {
+        const FaceArray faces = FaceArray::ensure(array);
+        if (!faces) {
+            throw py::error_already_set();
+        }
+        const int32_t* data = faces.data();
+        py::gil_scoped_release release;
+        check_face_indices(data, num_faces * 3);
+        return cfd::build_edge_topology(data, num_faces);
+    }
+    const WideFaceArray faces = WideFaceArray::ensure(array);
+    if (!faces) {
+        throw py::error_already_set();
+    }
+    const int64_t* data = faces.data();
+    py::gil_scoped_release release;
+    check_face_indices(data, num_faces * 3);
+    const std::vector<int32_t> narrow(data, data + num_faces * 3);
+    return cfd::build_edge_topology(narrow.data(), num_faces);
+}
+
+// (n, 2) int32 array of the (min, max) vertex pairs of the given edge ids
+py::array_t<int32_t> edge_array(const cfd::EdgeTopology& topology,
+                                const std::vector<int32_t>& edge_ids) {
+    py::array_t<int32_t> edges({py::ssize_t(edge_ids.size()), py::ssize_t(2)});
+    int32_t* out = edges.mutable_data();
+    for (size_t i = 0; i < edge_ids.size(); ++i) {
+        const uint64_t key = topology.keys[size_t(edge_ids[i])];
+        out[i * 2] = cfd::edge_key_first(key);
+        out[i * 2 + 1] = cfd::edge_key_second(key);
+    }
+    return edges;
+}
+
+py::array_t<int32_t> detect_free_edges_array(const py::array& faces) {
+    const cfd::EdgeTopology topology = topology_from_array(faces);
+    return edge_array(topology, cfd::free_edges(topology));
+}
+
+std::pair<py::array_t<int32_t>, double> detect_free_edges_array_with_timing(const py::array& faces) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto free_edges = detect_free_edges_array(faces);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return {free_edges, std::chrono::duration<double>(end_time - start_time).count()};
+}
+
+// Free edge detection on a shared Mesh: edges used by exactly one face in
+// the mesh's cached edge table, so repeated calls do not rebuild it
+py::array_t<int32_t> detect_free_edges_mesh(const cfd::Mesh& mesh) {
+    const cfd::EdgeTopology* topology = nullptr;
+    std::vector<int32_t> edge_ids;
+    {
+        py::gil_scoped_release release;
+        topology = &mesh.edges();
+        edge_ids = cfd::free_edges(*topology);
+    }
+    return edge_array(*topology, edge_ids);
+}
+
+std::pair<py::array_t<int32_t>, double> detect_free_edges_mesh_with_timing(const cfd::Mesh& mesh) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto free_edges = detect_free_edges_mesh(mesh);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return {free_edges, std::chrono::duration<double>(end_time - start_time).count()};
+}
+
+// Non-manifold edges: edges shared by more than two faces
+std::vector<std::pair<int, int>> detect_non_manifold_edges_cpp(
+    const std::vector<std::vector<int>>& faces) {
+    const std::vector<int32_t> flat = flatten_faces(faces);
+    const cfd::EdgeTopology topology = cfd::build_edge_topology(flat.data(), flat.size() / 3);
+    return edge_pairs(topology, cfd::non_manifold_edges(topology));
+}
+
+py::array_t<int32_t> detect_non_manifold_edges_array(const py::array& faces) {
+    const cfd::EdgeTopology topology = topology_from_array(faces);
+    return edge_array(topology, cfd::non_manifold_edges(topology));
+}
+
+py::array_t<int32_t> detect_non_manifold_edges_mesh(const cfd::Mesh& mesh) {
+    const cfd::EdgeTopology* topology = nullptr;
+    std::vector<int32_t> edge_ids;
+    {
+        py::gil_scoped_release release;
+        topology = &mesh.edges();
+        edge_ids = cfd::non_manifold_edges(*topology);
+    }
+    return edge_array(*topology, edge_ids);
+}
+
+// All unique edges with their faces: (edges (E, 2), offsets (E + 1,), faces),
+// the faces of edge e being faces[offsets[e]:offsets[e + 1]]
+py::tuple edge_face_incidence(const cfd::EdgeTopology& topology) {
+    py::array_t<int32_t> edges({py::ssize_t(topology.num_edges()), py::ssize_t(2)});
+    int32_t* out = edges.mutable_data();
+    for (size_t e = 0; e < topology.num_edges(); ++e) {
+        out[e * 2] = cfd::edge_key_first(topology.keys[e]);
+        out[e * 2 + 1] = cfd::edge_key_second(topology.keys[e]);
+    }
+    return py::make_tuple(edges, cfd::copy_to_array(topology.edge_faces.offsets),
+                          cfd::copy_to_array(topology.edge_faces.indices));
+}
+
+py::tuple edge_face_incidence_array(const py::array& faces) {
+    return edge_face_incidence(topology_from_array(faces));
+}
+
+py::tuple edge_face_incidence_cpp(const std::vector<std::vector<int>>& faces) {
+    const std::vector<int32_t> flat = flatten_faces(faces);
+    cfd::EdgeTopology topology;
+    {
+        py::gil_scoped_release release;
+        topology = cfd::build_edge_topology(flat.data(), flat.size() / 3);
+    }
+    return edge_face_incidence(topology);
+}
+
+py::tuple edge_face_incidence_mesh(const cfd::Mesh& mesh) {
+    const cfd::EdgeTopology* topology = nullptr;
+    {
+        py::gil_scoped_release release;
+        topology = &mesh.edges();
+    }
+    return edge_face_incidence(*topology);
+}
+
+// Free edges chained into ordered loops with per-loop metrics (see
+// cfd::boundary_loops); the walk runs with the GIL released
+py::dict detect_boundary_loops_mesh(const cfd::Mesh& mesh) {
+    cfd::BoundaryLoops loops;
+    {
+        py::gil_scoped_release release;
+        loops = cfd::boundary_loops(mesh);
+    }
+    return cfd::boundary_loops_to_dict(loops);
+}
+
+py::dict detect_boundary_loops_arrays(const py::array& vertices, const py::array& faces) {
+    return detect_boundary_loops_mesh(cfd::mesh_from_arrays(vertices, faces));
+}
+
 // Python module bindings
+// Overloads are tried in registration order: a mesh_reader_cpp.Mesh reuses
+// its cached edge table, NumPy arrays take the in-place int32 path and
+// returns arrays, nested lists keep the list-of-tuples interface
 PYBIND11_MODULE(free_edges_cpp, m) {
     m.doc() = "C++ implementation of free edge detection algorithm";
     
+    m.def("detect_free_edges", &detect_free_edges_mesh,
+          "Detect free edges in a mesh, returned as an (n, 2) int32 array", py::arg("mesh"));
+    m.def("detect_free_edges_with_timing", &detect_free_edges_mesh_with_timing,
+          "Detect free edges and return execution time", py::arg("mesh"));
+    
+    m.def("detect_free_edges", &detect_free_edges_array,
+          "Detect free edges in an (F, 3) face array, returned as an (n, 2) int32 array",
+          py::arg("faces"));
+    m.def("detect_free_edges_with_timing", &detect_free_edges_array_with_timing,
+          "Detect free edges and return execution time", py::arg("faces"));
+    
     // Bind free edge detection function
     m.def("detect_free_edges", &detect_free_edges_cpp, 
           "Detect free edges in a mesh", py::arg("faces"));
@@ -78,4 +262,28 @@ PYBIND11_MODULE(free_edges_cpp, m) {
     // Bind timed detection function
     m.def("detect_free_edges_with_timing", &detect_free_edges_with_timing,
           "Detect free edges and return execution time", py::arg("faces"));
-} 
\ No newline at end of file
+    
+    // Non-manifold edges (shared by more than two faces)
+    m.def("detect_non_manifold_edges", &detect_non_manifold_edges_mesh,
+          "Detect edges shared by more than two faces", py::arg("mesh"));
+    m.def("detect_non_manifold_edges", &detect_non_manifold_edges_array,
+          "Detect edges shared by more than two faces", py::arg("faces"));
+    m.def("detect_non_manifold_edges", &detect_non_manifold_edges_cpp,
+          "Detect edges shared by more than two faces", py::arg("faces"));
+    
+    // Unique edges with the faces using each of them, as NumPy arrays
+    m.def("edge_face_incidence", &edge_face_incidence_mesh,
+          "Return (edges, offsets, faces) arrays of the edge-to-face incidence", py::arg("mesh"));
+    m.def("edge_face_incidence", &edge_face_incidence_array,
+          "Return (edges, offsets, faces) arrays of the edge-to-face incidence", py::arg("faces"));
+    m.def("edge_face_incidence", &edge_face_incidence_cpp,
+          "Return (edges, offsets, faces) arrays of the edge-to-face incidence", py::arg("faces"));
+    
+    // Boundary loops: free edges assembled into closed loops / open chains
+    m.def("detect_boundary_loops", &detect_boundary_loops_mesh,
+          "Chain free edges into loops and report vertices, edge count, perimeter, area and bbox",
+          py::arg("mesh"));
+    m.def("detect_boundary_loops", &detect_boundary_loops_arrays,
+          "Chain free edges into loops and report vertices, edge count, perimeter, area and bbox",
+          py::arg("vertices"), py::arg("faces"));
+}
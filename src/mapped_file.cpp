@@ -0,0 +1,185 @@
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cfd {
+
+namespace {
+// Returned by data() for empty files so callers never see a null pointer.
+const char kEmptyBuffer[1] = {0};
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& file_path) : path_(file_path), data_(kEmptyBuffer) {
+    HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file: " + file_path);
+    }
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        close();
+        throw std::runtime_error("Cannot determine file size: " + file_path);
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0) {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        throw std::runtime_error("Cannot map file: " + file_path);
+    }
+    mapping_handle_ = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        close();
+        throw std::runtime_error("Cannot map file: " + file_path);
+    }
+    data_ = static_cast<const char*>(view);
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr && data_ != kEmptyBuffer) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+    }
+    data_ = kEmptyBuffer;
+    size_ = 0;
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)), data_(other.data_), size_(other.size_),
+      file_handle_(other.file_handle_), mapping_handle_(other.mapping_handle_) {
+    other.data_ = kEmptyBuffer;
+    other.size_ = 0;
+    other.file_handle_ = nullptr;
+    other.mapping_handle_ = nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+        file_handle_ = other.file_handle_;
+        mapping_handle_ = other.mapping_handle_;
+        other.data_ = kEmptyBuffer;
+        other.size_ = 0;
+        other.file_handle_ = nullptr;
+        other.mapping_handle_ = nullptr;
+    }
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& file_path) : path_(file_path), data_(kEmptyBuffer) {
+    fd_ = ::open(file_path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open file: " + file_path);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        close();
+        throw std::runtime_error("Cannot determine file size: " + file_path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {
+        return;
+    }
+
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        throw std::runtime_error("Cannot map file: " + file_path);
+    }
+    data_ = static_cast<const char*>(addr);
+    ::madvise(addr, size_, MADV_SEQUENTIAL);
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr && data_ != kEmptyBuffer) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    data_ = kEmptyBuffer;
+    size_ = 0;
+    fd_ = -1;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)), data_(other.data_), size_(other.size_), fd_(other.fd_) {
+    other.data_ = kEmptyBuffer;
+    other.size_ = 0;
+    other.fd_ = -1;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+        fd_ = other.fd_;
+        other.data_ = kEmptyBuffer;
+        other.size_ = 0;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+#endif
+
+void MappedFile::release(size_t offset, size_t length) const {
+#ifdef _WIN32
+    // The working set is trimmed by the OS; unmapping part of a view is not possible
+    (void)offset;
+    (void)length;
+#else
+    if (data_ == kEmptyBuffer || offset >= size_) {
+        return;
+    }
+    const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+    const size_t begin = (offset + page - 1) / page * page;
+    const size_t end = std::min(offset + length, size_) / page * page;
+    if (end > begin) {
+        ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+} // namespace cfd
@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace cfd {
+
+// Read-only memory mapping of a whole file.
+// The mapping is released when the object is destroyed.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const std::string& path() const { return path_; }
+
+    // Hints that [offset, offset + length) will not be read again so its pages
+    // can leave memory (they are read back from the file if touched). Used by
+    // streaming readers to keep their footprint bounded.
+    void release(size_t offset, size_t length) const;
+
+private:
+    void close();
+
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace cfd
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,515 @@
+#include "mesh_cache.hpp"
+#include "mesh_core.hpp"
+#include "phase_timer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace cfd {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'F', 'D', 'M', 'E', 'S', 'H', '\0'};
+constexpr uint32_t kHasTopology = 1u << 0;
+constexpr uint64_t kSectionAlignment = 64;
+constexpr size_t kHashedBytes = 64 * 1024;
+
+enum SectionType : uint32_t {
+    kVertices = 1,
+    kFaces = 2,
+    kNormals = 3,
+    kQuads = 4,
+    kEdges = 5,
+    kEdgeFaceOffsets = 6,
+    kEdgeFaces = 7,
+    kSolids = 8,
+};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t vertex_count;
+    uint64_t face_count;
+    uint64_t normal_count;
+    uint64_t quad_count;
+    uint64_t edge_count;
+    uint64_t edge_face_count;
+    float bbox_min[3];
+    float bbox_max[3];
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t source_hash;
+    uint64_t options_hash;
+    uint64_t payload_hash;  // payload_checksum() of the section table and sections
+    uint32_t section_count;
+    uint32_t reserved;
+};
+static_assert(sizeof(CacheHeader) == 136, "CacheHeader layout changed");
+
+struct SectionEntry {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+uint64_t fnv1a(const char* data, size_t size, uint64_t h = 0xcbf29ce484222325ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Checksum of the cache payload, so a file whose header and section sizes
+// are intact but whose arrays are not (e.g. a torn write) is rejected. Four
+// independent 64-bit lanes keep it at memory speed; the tail goes through
+// fnv1a.
+uint64_t payload_checksum(const char* data, size_t size, uint64_t seed) {
+    constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+    constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+    auto round = [](uint64_t acc, uint64_t word) {
+        acc += word * kPrime2;
+        acc = (acc << 31) | (acc >> 33);
+        return acc * kPrime1;
+    };
+    uint64_t lanes[4] = {seed + kPrime1, seed + kPrime2, seed, seed - kPrime1};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, data + i + size_t(k) * 8, sizeof(word));
+            lanes[k] = round(lanes[k], word);
+        }
+    }
+    uint64_t h = uint64_t(size);
+    for (int k = 0; k < 4; ++k) {
+        h = round(h ^ lanes[k], kPrime1);
+    }
+    return fnv1a(data + i, size - i, h);
+}
+
+struct SourceFingerprint {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+// Size, modification time and a hash of the first and last 64 KiB; cheap
+// enough to check on every open, even for multi-GB decks
+SourceFingerprint fingerprint_source(const std::string& source_path) {
+    SourceFingerprint fp;
+    const std::filesystem::path path(source_path);
+    fp.size = std::filesystem::file_size(path);
+    fp.mtime = int64_t(std::filesystem::last_write_time(path).time_since_epoch().count());
+
+    MappedFile file(source_path);
+    const size_t head = std::min(file.size(), kHashedBytes);
+    fp.hash = fnv1a(file.data(), head);
+    if (file.size() > head) {
+        const size_t tail = std::min(file.size() - head, kHashedBytes);
+        fp.hash = fnv1a(file.data() + file.size() - tail, tail, fp.hash);
+    }
+    return fp;
+}
+
+// Only the options that change the parsed mesh take part
+uint64_t options_fingerprint(const ReadOptions& options) {
+    const char weld = options.weld_vertices ? 1 : 0;
+    const char split = options.split_quads ? 1 : 0;
+    uint64_t h = fnv1a(&weld, 1);
+    h = fnv1a(reinterpret_cast<const char*>(&options.weld_tolerance), sizeof(float), h);
+    return fnv1a(&split, 1, h);
+}
+
+uint64_t align_up(uint64_t value) {
+    return (value + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+// Unique edges of the triangle faces (sorted by vertex pair) and the faces
+// incident to each edge in CSR form
+void build_edge_tables(const RowMatrixXi& faces, std::vector<int>& edges,
+                       std::vector<int>& offsets, std::vector<int>& edge_faces) {
+    EdgeTopology topology = build_edge_topology(faces.data(), size_t(faces.rows()));
+    edges.resize(topology.num_edges() * 2);
+    for (size_t e = 0; e < topology.num_edges(); ++e) {
+        edges[e * 2] = edge_key_first(topology.keys[e]);
+        edges[e * 2 + 1] = edge_key_second(topology.keys[e]);
+    }
+    offsets = std::move(topology.edge_faces.offsets);
+    edge_faces = std::move(topology.edge_faces.indices);
+}
+
+} // namespace
+
+std::string mesh_cache_path(const std::string& source_path) {
+    return source_path + ".cfdcache";
+}
+
+void write_mesh_cache(const std::string& cache_path, const std::string& source_path,
+                      const MeshData& mesh, const ReadOptions& options,
+                      bool include_topology) {
+    const SourceFingerprint fp = fingerprint_source(source_path);
+
+    const RowMatrixXf& vertices = mesh.vertices;
+    const RowMatrixXi& faces = mesh.faces;
+    const RowMatrixXf& normals = mesh.normals;
+    const RowMatrixXi& quads = mesh.quads;
+
+    std::vector<int> edges, edge_face_offsets, edge_faces;
+    if (include_topology) {
+        build_edge_tables(mesh.faces, edges, edge_face_offsets, edge_faces);
+    }
+
+    // Solid ranges: per solid uint64 first face, uint64 face count, uint32
+    // name length and the name bytes, packed
+    std::vector<char> solids;
+    for (const SolidRange& solid : mesh.solids) {
+        const uint64_t range[2] = {solid.first_face, solid.face_count};
+        const uint32_t name_length = uint32_t(solid.name.size());
+        solids.insert(solids.end(), reinterpret_cast<const char*>(range),
+                      reinterpret_cast<const char*>(range) + sizeof(range));
+        solids.insert(solids.end(), reinterpret_cast<const char*>(&name_length),
+                      reinterpret_cast<const char*>(&name_length) + sizeof(name_length));
+        solids.insert(solids.end(), solid.name.begin(), solid.name.end());
+    }
+
+    std::vector<std::pair<uint32_t, std::pair<const char*, uint64_t>>> sections;
+    auto add_section = [&](uint32_t type, const void* data, uint64_t bytes) {
+        sections.push_back({type, {static_cast<const char*>(data), bytes}});
+    };
+    add_section(kVertices, vertices.data(), uint64_t(vertices.size()) * sizeof(float));
+    add_section(kFaces, faces.data(), uint64_t(faces.size()) * sizeof(int));
+    if (normals.size() > 0) {
+        add_section(kNormals, normals.data(), uint64_t(normals.size()) * sizeof(float));
+    }
+    if (quads.size() > 0) {
+        add_section(kQuads, quads.data(), uint64_t(quads.size()) * sizeof(int));
+    }
+    if (!solids.empty()) {
+        add_section(kSolids, solids.data(), solids.size());
+    }
+    if (include_topology) {
+        add_section(kEdges, edges.data(), uint64_t(edges.size()) * sizeof(int));
+        add_section(kEdgeFaceOffsets, edge_face_offsets.data(),
+                    uint64_t(edge_face_offsets.size()) * sizeof(int));
+        add_section(kEdgeFaces, edge_faces.data(), uint64_t(edge_faces.size()) * sizeof(int));
+    }
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kMeshCacheVersion;
+    header.flags = include_topology ? kHasTopology : 0;
+    header.vertex_count = uint64_t(mesh.vertices.rows());
+    header.face_count = uint64_t(mesh.faces.rows());
+    header.normal_count = uint64_t(mesh.normals.rows());
+    header.quad_count = uint64_t(mesh.quads.rows());
+    header.edge_count = edges.size() / 2;
+    header.edge_face_count = edge_faces.size();
+    if (mesh.vertices.rows() > 0) {
+        const Eigen::RowVector3f lo = mesh.vertices.colwise().minCoeff();
+        const Eigen::RowVector3f hi = mesh.vertices.colwise().maxCoeff();
+        for (int k = 0; k < 3; ++k) {
+            header.bbox_min[k] = lo[k];
+            header.bbox_max[k] = hi[k];
+        }
+    }
+    header.source_size = fp.size;
+    header.source_mtime = fp.mtime;
+    header.source_hash = fp.hash;
+    header.options_hash = options_fingerprint(options);
+    header.section_count = uint32_t(sections.size());
+
+    std::vector<SectionEntry> table(sections.size());
+    uint64_t offset = align_up(sizeof(CacheHeader) + sizeof(SectionEntry) * table.size());
+    for (size_t i = 0; i < sections.size(); ++i) {
+        table[i].type = sections[i].first;
+        table[i].reserved = 0;
+        table[i].offset = offset;
+        table[i].bytes = sections[i].second.second;
+        offset = align_up(offset + table[i].bytes);
+    }
+    header.payload_hash = payload_checksum(reinterpret_cast<const char*>(table.data()),
+                                           sizeof(SectionEntry) * table.size(), 0);
+    for (const auto& section : sections) {
+        header.payload_hash = payload_checksum(section.second.first, size_t(section.second.second),
+                                               header.payload_hash);
+    }
+
+    // Written under a temporary name unique to this writer and renamed, so a
+    // reader never sees a half-written cache, even when several processes
+    // cache the same deck at once
+    std::random_device random;
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = int(getpid());
+#endif
+    const std::string temp_path = cache_path + ".tmp." + std::to_string(pid) + "." +
+                                  std::to_string(random());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create cache file: " + temp_path);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  std::streamsize(sizeof(SectionEntry) * table.size()));
+
+        static const char padding[kSectionAlignment] = {0};
+        uint64_t written = sizeof(CacheHeader) + sizeof(SectionEntry) * table.size();
+        for (size_t i = 0; i < sections.size(); ++i) {
+            out.write(padding, std::streamsize(table[i].offset - written));
+            out.write(sections[i].second.first, std::streamsize(table[i].bytes));
+            written = table[i].offset + table[i].bytes;
+        }
+        if (!out) {
+            throw std::runtime_error("Cannot write cache file: " + temp_path);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, cache_path, ec);
+    if (ec) {
+        std::filesystem::remove(cache_path, ec);
+        std::filesystem::rename(temp_path, cache_path, ec);
+    }
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        throw std::runtime_error("Cannot replace cache file: " + cache_path);
+    }
+}
+
+MeshCache::MeshCache(const std::string& cache_path) : file_(cache_path) {
+    CacheHeader header;
+    if (file_.size() < sizeof(header)) {
+        throw std::runtime_error("Mesh cache file is truncated: " + cache_path);
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a mesh cache file: " + cache_path);
+    }
+    if (header.version != kMeshCacheVersion) {
+        throw std::runtime_error("Unsupported mesh cache version " +
+                                 std::to_string(header.version) + ": " + cache_path);
+    }
+    if (file_.size() < sizeof(header) + uint64_t(header.section_count) * sizeof(SectionEntry)) {
+        throw std::runtime_error("Mesh cache file is truncated: " + cache_path);
+    }
+
+    vertex_count_ = header.vertex_count;
+    face_count_ = header.face_count;
+    normal_count_ = header.normal_count;
+    quad_count_ = header.quad_count;
+    edge_count_ = header.edge_count;
+    edge_face_count_ = header.edge_face_count;
+    has_topology_ = (header.flags & kHasTopology) != 0;
+    std::copy(header.bbox_min, header.bbox_min + 3, bbox_min_);
+    std::copy(header.bbox_max, header.bbox_max + 3, bbox_max_);
+    source_size_ = header.source_size;
+    source_mtime_ = header.source_mtime;
+    source_hash_ = header.source_hash;
+    options_hash_ = header.options_hash;
+
+    // Validate every section up front so the accessors cannot fail later
+    section(kVertices, vertex_count_ * 3 * sizeof(float));
+    section(kFaces, face_count_ * 3 * sizeof(int));
+    if (normal_count_ > 0) section(kNormals, normal_count_ * 3 * sizeof(float));
+    if (quad_count_ > 0) section(kQuads, quad_count_ * 4 * sizeof(int));
+    if (has_topology_) {
+        section(kEdges, edge_count_ * 2 * sizeof(int));
+        section(kEdgeFaceOffsets, (edge_count_ + 1) * sizeof(int));
+        section(kEdgeFaces, edge_face_count_ * sizeof(int));
+    }
+
+    // A torn write can leave intact counts and sizes over zero-filled arrays
+    uint64_t checksum = payload_checksum(file_.data() + sizeof(header),
+                                         sizeof(SectionEntry) * header.section_count, 0);
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, file_.data() + sizeof(header) + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.offset > file_.size() || file_.size() - entry.offset < entry.bytes) {
+            throw std::runtime_error("Corrupt mesh cache section in " + cache_path);
+        }
+        checksum = payload_checksum(file_.data() + entry.offset, size_t(entry.bytes), checksum);
+    }
+    if (checksum != header.payload_hash) {
+        throw std::runtime_error("Mesh cache checksum mismatch: " + cache_path);
+    }
+
+    const char* solids = nullptr;
+    uint64_t solid_bytes = 0;
+    if (find_section(kSolids, solids, solid_bytes)) {
+        const char* const solids_end = solids + solid_bytes;
+        while (solids < solids_end) {
+            uint64_t range[2];
+            uint32_t name_length;
+            if (uint64_t(solids_end - solids) < sizeof(range) + sizeof(name_length)) {
+                throw std::runtime_error("Corrupt mesh cache section in " + cache_path);
+            }
+            std::memcpy(range, solids, sizeof(range));
+            std::memcpy(&name_length, solids + sizeof(range), sizeof(name_length));
+            solids += sizeof(range) + sizeof(name_length);
+            if (uint64_t(solids_end - solids) < name_length ||
+                range[0] + range[1] > face_count_) {
+                throw std::runtime_error("Corrupt mesh cache section in " + cache_path);
+            }
+            solids_.push_back(SolidRange{std::string(solids, name_length), size_t(range[0]),
+                                         size_t(range[1])});
+            solids += name_length;
+        }
+    }
+}
+
+bool MeshCache::find_section(uint32_t type, const char*& data, uint64_t& bytes) const {
+    CacheHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    const char* table = file_.data() + sizeof(header);
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, table + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.type != type) continue;
+        if (entry.offset > file_.size() || file_.size() - entry.offset < entry.bytes) {
+            throw std::runtime_error("Corrupt mesh cache section in " + file_.path());
+        }
+        data = file_.data() + entry.offset;
+        bytes = entry.bytes;
+        return true;
+    }
+    return false;
+}
+
+const char* MeshCache::section(uint32_t type, uint64_t expected_bytes) const {
+    const char* data;
+    uint64_t bytes;
+    if (find_section(type, data, bytes)) {
+        if (bytes < expected_bytes) {
+            throw std::runtime_error("Corrupt mesh cache section in " + file_.path());
+        }
+        return data;
+    }
+    if (expected_bytes == 0) {
+        return file_.data();
+    }
+    throw std::runtime_error("Missing mesh cache section in " + file_.path());
+}
+
+bool MeshCache::is_fresh(const std::string& source_path, const ReadOptions& options) const {
+    if (options_hash_ != options_fingerprint(options)) {
+        return false;
+    }
+    const SourceFingerprint fp = fingerprint_source(source_path);
+    return fp.size == source_size_ && fp.mtime == source_mtime_ && fp.hash == source_hash_;
+}
+
+Eigen::Map<const RowMatrixXf> MeshCache::vertices() const {
+    return {reinterpret_cast<const float*>(section(kVertices, vertex_count_ * 3 * sizeof(float))),
+            Eigen::Index(vertex_count_), 3};
+}
+
+Eigen::Map<const RowMatrixXi> MeshCache::faces() const {
+    return {reinterpret_cast<const int*>(section(kFaces, face_count_ * 3 * sizeof(int))),
+            Eigen::Index(face_count_), 3};
+}
+
+Eigen::Map<const RowMatrixXf> MeshCache::normals() const {
+    const char* data = normal_count_ > 0 ? section(kNormals, normal_count_ * 3 * sizeof(float))
+                                         : file_.data();
+    return {reinterpret_cast<const float*>(data), Eigen::Index(normal_count_),
+            normal_count_ > 0 ? 3 : 0};
+}
+
+Eigen::Map<const RowMatrixXi> MeshCache::quads() const {
+    const char* data = quad_count_ > 0 ? section(kQuads, quad_count_ * 4 * sizeof(int))
+                                       : file_.data();
+    return {reinterpret_cast<const int*>(data), Eigen::Index(quad_count_),
+            quad_count_ > 0 ? 4 : 0};
+}
+
+Eigen::Map<const RowMatrixXi> MeshCache::edges() const {
+    if (!has_topology_) {
+        throw std::runtime_error("Mesh cache has no topology tables: " + file_.path());
+    }
+    return {reinterpret_cast<const int*>(section(kEdges, edge_count_ * 2 * sizeof(int))),
+            Eigen::Index(edge_count_), 2};
+}
+
+Eigen::Map<const Eigen::VectorXi> MeshCache::edge_face_offsets() const {
+    if (!has_topology_) {
+        throw std::runtime_error("Mesh cache has no topology tables: " + file_.path());
+    }
+    return {reinterpret_cast<const int*>(section(kEdgeFaceOffsets, (edge_count_ + 1) * sizeof(int))),
+            Eigen::Index(edge_count_ + 1)};
+}
+
+Eigen::Map<const Eigen::VectorXi> MeshCache::edge_faces() const {
+    if (!has_topology_) {
+        throw std::runtime_error("Mesh cache has no topology tables: " + file_.path());
+    }
+    return {reinterpret_cast<const int*>(section(kEdgeFaces, edge_face_count_ * sizeof(int))),
+            Eigen::Index(edge_face_count_)};
+}
+
+MeshData MeshCache::to_mesh_data() const {
+    MeshData mesh;
+    mesh.vertices = vertices();
+    mesh.faces = faces();
+    mesh.normals = normals();
+    mesh.quads = quads();
+    mesh.solids = solids_;
+    return mesh;
+}
+
+MeshData read_with_cache(const std::string& file_path, const ReadOptions& options,
+                         const std::function<MeshData()>& parse, LoadStats* stats) {
+    if (!options.use_cache) {
+        return parse();
+    }
+
+    LoadStats ignored;
+    LoadStats& s = stats ? *stats : ignored;
+    PhaseTimer timer(s);
+
+    const std::string cache_path = mesh_cache_path(file_path);
+    std::error_code ec;
+    if (std::filesystem::exists(cache_path, ec)) {
+        try {
+            MeshCache cache(cache_path);
+            if (cache.is_fresh(file_path, options)) {
+                MeshData mesh = cache.to_mesh_data();
+                s.from_cache = true;
+                s.bytes_read = std::filesystem::file_size(cache_path, ec);
+                timer.lap("cache_load");
+                return mesh;
+            }
+        } catch (const std::exception&) {
+            // Unreadable or outdated cache: parse the source again
+        }
+    }
+    timer.lap("cache_check");
+
+    MeshData mesh = parse();
+    PhaseTimer write_timer(s);
+    try {
+        write_mesh_cache(cache_path, file_path, mesh, options);
+    } catch (const std::exception&) {
+        // Caching is best effort, e.g. the directory may be read-only
+    }
+    write_timer.lap("cache_write");
+    return mesh;
+}
+
+} // namespace cfd
@@ -0,0 +1,93 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include "mesh_reader.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cfd {
+
+// Binary mesh cache stored next to a source mesh as "<file>.cfdcache".
+//
+// Layout (little endian): a fixed header with counts, bounding box and a
+// fingerprint of the source file (size, modification time, hash of its first
+// and last 64 KiB), of the ReadOptions it was parsed with and a checksum of
+// the payload, followed by a section table and 64-byte aligned raw arrays
+// stored row-major:
+//   vertices float32 Nx3, faces int32 Mx3, normals float32 Mx3 (optional),
+//   quads int32 Kx4 (optional), ASCII STL solid ranges (optional), and
+//   optionally the unique edges int32 Ex2 with their edge->face incidence in
+//   CSR form (offsets int32 E+1, faces).
+constexpr uint32_t kMeshCacheVersion = 3;
+
+// Path of the cache file belonging to a source mesh file
+std::string mesh_cache_path(const std::string& source_path);
+
+// Writes the cache for `mesh` parsed from `source_path` with `options`.
+// With include_topology the edge and edge->face tables are stored as well.
+void write_mesh_cache(const std::string& cache_path, const std::string& source_path,
+                      const MeshData& mesh, const ReadOptions& options,
+                      bool include_topology = false);
+
+// A cache file mapped into memory. The accessors return views of the mapping,
+// so nothing is copied until to_mesh_data() is called. Opening verifies the
+// payload checksum and throws std::runtime_error on a mismatch.
+class MeshCache {
+public:
+    explicit MeshCache(const std::string& cache_path);
+
+    // True when the cache was written for the current contents of
+    // source_path and the same parse options
+    bool is_fresh(const std::string& source_path, const ReadOptions& options) const;
+
+    Eigen::Map<const RowMatrixXf> vertices() const;
+    Eigen::Map<const RowMatrixXi> faces() const;
+    Eigen::Map<const RowMatrixXf> normals() const;
+    Eigen::Map<const RowMatrixXi> quads() const;
+
+    bool has_topology() const { return has_topology_; }
+    Eigen::Map<const RowMatrixXi> edges() const;
+    Eigen::Map<const Eigen::VectorXi> edge_face_offsets() const;
+    Eigen::Map<const Eigen::VectorXi> edge_faces() const;
+
+    const std::vector<SolidRange>& solids() const { return solids_; }
+
+    Eigen::Vector3f bbox_min() const { return Eigen::Vector3f(bbox_min_); }
+    Eigen::Vector3f bbox_max() const { return Eigen::Vector3f(bbox_max_); }
+
+    MeshData to_mesh_data() const;
+
+private:
+    bool find_section(uint32_t type, const char*& data, uint64_t& bytes) const;
+    const char* section(uint32_t type, uint64_t expected_bytes) const;
+
+    MappedFile file_;
+    uint64_t vertex_count_ = 0;
+    uint64_t face_count_ = 0;
+    uint64_t normal_count_ = 0;
+    uint64_t quad_count_ = 0;
+    uint64_t edge_count_ = 0;
+    uint64_t edge_face_count_ = 0;
+    bool has_topology_ = false;
+    float bbox_min_[3] = {0.0f, 0.0f, 0.0f};
+    float bbox_max_[3] = {0.0f, 0.0f, 0.0f};
+    uint64_t source_size_ = 0;
+    int64_t source_mtime_ = 0;
+    uint64_t source_hash_ = 0;
+    uint64_t options_hash_ = 0;
+    std::vector<SolidRange> solids_;
+};
+
+// Returns the contents of a fresh cache for file_path when there is one,
+// otherwise calls parse() and (best effort) writes the cache for next time.
+// Cache phases and from_cache are recorded in stats when given.
+MeshData read_with_cache(const std::string& file_path, const ReadOptions& options,
+                         const std::function<MeshData()>& parse, LoadStats* stats = nullptr);
+
+} // namespace cfd
+
+#endif // MESH_CACHE_HPP
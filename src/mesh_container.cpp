@@ -0,0 +1,394 @@
+#include "mesh_reader.hpp"
+#include "mesh_writer.hpp"
+#include "mapped_file.hpp"
+#include "parallel_utils.hpp"
+#include "phase_timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// CMZ container layout (little endian):
+//   CmzHeader, then block_count BlockEntry records, then the block payloads.
+// Vertex blocks hold per-axis quantized coordinates, each delta encoded
+// against the previous vertex of the same block; normal blocks do the same
+// with 16 bits on the normals' own bounding box; face and quad blocks hold each index delta encoded against the
+// previous index of the block. All values are zigzag varints, so every block
+// decodes on its own. A solids block stores MeshData::solids.
+
+namespace cfd {
+
+namespace {
+
+constexpr char kCmzMagic[8] = {'C', 'F', 'D', 'M', 'C', 'M', 'Z', '\0'};
+constexpr uint32_t kCmzVersion = 1;
+constexpr size_t kRowsPerBlock = 1 << 16;
+constexpr int kNormalBits = 16;
+
+enum BlockType : uint32_t {
+    kVertexBlock = 1,
+    kFaceBlock = 2,
+    kNormalBlock = 3,
+    kQuadBlock = 4,
+    kSolidsBlock = 5,
+};
+
+struct CmzHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t quantization_bits;
+    uint64_t vertex_count;
+    uint64_t face_count;
+    uint64_t normal_count;
+    uint64_t quad_count;
+    float bbox_min[3];
+    float bbox_max[3];
+    float normal_min[3];
+    float normal_max[3];
+    uint32_t block_count;
+    uint32_t reserved;
+};
+static_assert(sizeof(CmzHeader) == 104, "CmzHeader layout changed");
+
+struct BlockEntry {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t first;
+    uint64_t count;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += char(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out += char(value);
+}
+
+uint64_t get_varint(const uint8_t*& p, const uint8_t* end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            throw std::runtime_error("Corrupt CMZ block");
+        }
+        const uint8_t byte = *p++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Corrupt CMZ block");
+}
+
+uint64_t zigzag(int64_t value) {
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+// Maps [lo, hi] per axis onto integers 0 .. 2^bits - 1 and back
+struct Quantizer {
+    double lo[3];
+    double step[3];
+    double max_q;
+
+    Quantizer(const float* lo_, const float* hi_, int bits) : max_q(double((uint64_t(1) << bits) - 1)) {
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = lo_[k];
+            step[k] = hi_[k] > lo_[k] ? (double(hi_[k]) - lo_[k]) / max_q : 0.0;
+        }
+    }
+
+    int64_t quantize(float value, int k) const {
+        if (step[k] == 0.0) return 0;
+        const double q = std::round((double(value) - lo[k]) / step[k]);
+        return int64_t(std::min(std::max(q, 0.0), max_q));
+    }
+
+    float dequantize(int64_t q, int k) const {
+        return float(lo[k] + double(q) * step[k]);
+    }
+};
+
+void encode_points(const RowMatrixXf& points, size_t first, size_t count, const Quantizer& quantizer,
+                   std::string& out) {
+    int64_t previous[3] = {0, 0, 0};
+    for (size_t i = first; i < first + count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            const int64_t q = quantizer.quantize(points(Eigen::Index(i), k), k);
+            put_varint(out, zigzag(q - previous[k]));
+            previous[k] = q;
+        }
+    }
+}
+
+void decode_points(const uint8_t* p, const uint8_t* end, size_t first, size_t count,
+                   const Quantizer& quantizer, RowMatrixXf& points) {
+    int64_t previous[3] = {0, 0, 0};
+    float* out = points.data() + first * 3;
+    for (size_t i = 0; i < count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            previous[k] += unzigzag(get_varint(p, end));
+            *out++ = quantizer.dequantize(previous[k], k);
+        }
+    }
+}
+
+void encode_indices(const RowMatrixXi& cells, size_t first, size_t count, std::string& out) {
+    int64_t previous = 0;
+    const int* p = cells.data() + first * size_t(cells.cols());
+    const int* const end = p + count * size_t(cells.cols());
+    for (; p < end; ++p) {
+        put_varint(out, zigzag(int64_t(*p) - previous));
+        previous = *p;
+    }
+}
+
+void decode_indices(const uint8_t* p, const uint8_t* end, size_t first, size_t count,
+                    int64_t vertex_count, RowMatrixXi& cells) {
+    int64_t previous = 0;
+    int* out = cells.data() + first * size_t(cells.cols());
+    int* const out_end = out + count * size_t(cells.cols());
+    for (; out < out_end; ++out) {
+        previous += unzigzag(get_varint(p, end));
+        if (previous < 0 || previous >= vertex_count) {
+            throw std::runtime_error("Corrupt CMZ block: vertex index out of range");
+        }
+        *out = int(previous);
+    }
+}
+
+void encode_solids(const std::vector<SolidRange>& solids, std::string& out) {
+    for (const SolidRange& solid : solids) {
+        put_varint(out, solid.first_face);
+        put_varint(out, solid.face_count);
+        put_varint(out, solid.name.size());
+        out += solid.name;
+    }
+}
+
+std::vector<SolidRange> decode_solids(const uint8_t* p, const uint8_t* end, size_t face_count) {
+    std::vector<SolidRange> solids;
+    while (p < end) {
+        SolidRange solid;
+        solid.first_face = size_t(get_varint(p, end));
+        solid.face_count = size_t(get_varint(p, end));
+        const uint64_t name_length = get_varint(p, end);
+        if (uint64_t(end - p) < name_length || solid.first_face + solid.face_count > face_count) {
+            throw std::runtime_error("Corrupt CMZ solids block");
+        }
+        solid.name.assign(reinterpret_cast<const char*>(p), size_t(name_length));
+        p += name_length;
+        solids.push_back(std::move(solid));
+    }
+    return solids;
+}
+
+} // namespace
+
+void CMZWriter::write(const MeshData& mesh, const std::string& file_path) {
+    if (options_.quantization_bits < 1 || options_.quantization_bits > 31) {
+        throw std::runtime_error("quantization_bits must be between 1 and 31");
+    }
+    if ((mesh.vertices.size() > 0 && mesh.vertices.cols() != 3) ||
+        (mesh.faces.size() > 0 && mesh.faces.cols() != 3) ||
+        (mesh.normals.size() > 0 && mesh.normals.cols() != 3) ||
+        (mesh.quads.size() > 0 && mesh.quads.cols() != 4)) {
+        throw std::runtime_error("MeshData arrays must be Nx3 vertices, Mx3 faces and Kx4 quads");
+    }
+    // A non-finite value would make the bounding box, and so the quantizer
+    // step, infinite or NaN
+    if (!mesh.vertices.allFinite()) {
+        throw std::runtime_error("Cannot write CMZ: vertex coordinates must be finite");
+    }
+    if (!mesh.normals.allFinite()) {
+        throw std::runtime_error("Cannot write CMZ: normals must be finite");
+    }
+
+    CmzHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kCmzMagic, sizeof(kCmzMagic));
+    header.version = kCmzVersion;
+    header.quantization_bits = uint32_t(options_.quantization_bits);
+    header.vertex_count = uint64_t(mesh.vertices.rows());
+    header.face_count = uint64_t(mesh.faces.rows());
+    header.normal_count = uint64_t(mesh.normals.rows());
+    header.quad_count = uint64_t(mesh.quads.rows());
+    if (mesh.vertices.rows() > 0) {
+        const Eigen::RowVector3f lo = mesh.vertices.colwise().minCoeff();
+        const Eigen::RowVector3f hi = mesh.vertices.colwise().maxCoeff();
+        for (int k = 0; k < 3; ++k) {
+            header.bbox_min[k] = lo[k];
+            header.bbox_max[k] = hi[k];
+        }
+    }
+    if (mesh.normals.rows() > 0) {
+        const Eigen::RowVector3f lo = mesh.normals.colwise().minCoeff();
+        const Eigen::RowVector3f hi = mesh.normals.colwise().maxCoeff();
+        for (int k = 0; k < 3; ++k) {
+            header.normal_min[k] = lo[k];
+            header.normal_max[k] = hi[k];
+        }
+    }
+    const Quantizer vertex_quantizer(header.bbox_min, header.bbox_max, options_.quantization_bits);
+    const Quantizer normal_quantizer(header.normal_min, header.normal_max, kNormalBits);
+
+    std::vector<BlockEntry> table;
+    auto add_blocks = [&](uint32_t type, size_t rows) {
+        for (size_t first = 0; first < rows; first += kRowsPerBlock) {
+            table.push_back(BlockEntry{type, 0, first, std::min(kRowsPerBlock, rows - first), 0, 0});
+        }
+    };
+    add_blocks(kVertexBlock, size_t(mesh.vertices.rows()));
+    add_blocks(kFaceBlock, size_t(mesh.faces.rows()));
+    add_blocks(kNormalBlock, size_t(mesh.normals.rows()));
+    add_blocks(kQuadBlock, size_t(mesh.quads.rows()));
+    if (!mesh.solids.empty()) {
+        table.push_back(BlockEntry{kSolidsBlock, 0, 0, mesh.solids.size(), 0, 0});
+    }
+
+    std::vector<std::string> payloads(table.size());
+    parallel_for(0, table.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            const BlockEntry& entry = table[b];
+            std::string& out = payloads[b];
+            switch (entry.type) {
+            case kVertexBlock:
+                encode_points(mesh.vertices, entry.first, entry.count, vertex_quantizer, out);
+                break;
+            case kNormalBlock:
+                encode_points(mesh.normals, entry.first, entry.count, normal_quantizer, out);
+                break;
+            case kFaceBlock:
+                encode_indices(mesh.faces, entry.first, entry.count, out);
+                break;
+            case kQuadBlock:
+                encode_indices(mesh.quads, entry.first, entry.count, out);
+                break;
+            case kSolidsBlock:
+                encode_solids(mesh.solids, out);
+                break;
+            }
+        }
+    }, options_.num_threads);
+
+    header.block_count = uint32_t(table.size());
+    uint64_t offset = sizeof(CmzHeader) + sizeof(BlockEntry) * table.size();
+    for (size_t b = 0; b < table.size(); ++b) {
+        table[b].offset = offset;
+        table[b].bytes = payloads[b].size();
+        offset += payloads[b].size();
+    }
+
+    std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create file: " + file_path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()),
+              std::streamsize(sizeof(BlockEntry) * table.size()));
+    for (const std::string& payload : payloads) {
+        out.write(payload.data(), std::streamsize(payload.size()));
+    }
+    if (!out) {
+        throw std::runtime_error("Cannot write file: " + file_path);
+    }
+}
+
+MeshData CMZReader::read(const std::string& file_path) {
+    stats_ = LoadStats();
+    PhaseTimer timer(stats_);
+    MappedFile file(file_path);
+    stats_.bytes_read = file.size();
+    timer.lap("map");
+
+    CmzHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("CMZ file is truncated: " + file_path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kCmzMagic, sizeof(kCmzMagic)) != 0) {
+        throw std::runtime_error("Not a CMZ file: " + file_path);
+    }
+    if (header.version != kCmzVersion) {
+        throw std::runtime_error("Unsupported CMZ version " + std::to_string(header.version) +
+                                 ": " + file_path);
+    }
+    if (header.quantization_bits < 1 || header.quantization_bits > 31 ||
+        header.vertex_count > uint64_t(INT32_MAX) ||
+        file.size() < sizeof(header) + uint64_t(header.block_count) * sizeof(BlockEntry)) {
+        throw std::runtime_error("Corrupt CMZ file: " + file_path);
+    }
+
+    std::vector<BlockEntry> table(header.block_count);
+    std::memcpy(table.data(), file.data() + sizeof(header), sizeof(BlockEntry) * table.size());
+    // Each array must be tiled by its blocks in order, so every row is decoded
+    uint64_t next_row[kSolidsBlock + 1] = {0, 0, 0, 0, 0, 0};
+    for (const BlockEntry& entry : table) {
+        if (entry.type < kVertexBlock || entry.type > kSolidsBlock || entry.offset > file.size() ||
+            file.size() - entry.offset < entry.bytes ||
+            (entry.type != kSolidsBlock && entry.first != next_row[entry.type])) {
+            throw std::runtime_error("Corrupt CMZ block table: " + file_path);
+        }
+        next_row[entry.type] += entry.count;
+    }
+    if (next_row[kVertexBlock] != header.vertex_count || next_row[kFaceBlock] != header.face_count ||
+        next_row[kNormalBlock] != header.normal_count || next_row[kQuadBlock] != header.quad_count) {
+        throw std::runtime_error("Corrupt CMZ block table: " + file_path);
+    }
+
+    MeshData mesh;
+    mesh.vertices.resize(Eigen::Index(header.vertex_count), 3);
+    mesh.faces.resize(Eigen::Index(header.face_count), 3);
+    mesh.normals.resize(Eigen::Index(header.normal_count), 3);
+    mesh.quads.resize(Eigen::Index(header.quad_count), 4);
+
+    const Quantizer vertex_quantizer(header.bbox_min, header.bbox_max, int(header.quantization_bits));
+    const Quantizer normal_quantizer(header.normal_min, header.normal_max, kNormalBits);
+    const int64_t vertex_count = int64_t(header.vertex_count);
+
+    // Blocks cover disjoint row ranges, so each decodes straight into place
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(file.data());
+    parallel_for(0, table.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            const BlockEntry& entry = table[b];
+            const uint8_t* p = base + entry.offset;
+            const uint8_t* p_end = p + entry.bytes;
+            switch (entry.type) {
+            case kVertexBlock:
+                decode_points(p, p_end, entry.first, entry.count, vertex_quantizer, mesh.vertices);
+                break;
+            case kNormalBlock:
+                decode_points(p, p_end, entry.first, entry.count, normal_quantizer, mesh.normals);
+                break;
+            case kFaceBlock:
+                decode_indices(p, p_end, entry.first, entry.count, vertex_count, mesh.faces);
+                break;
+            case kQuadBlock:
+                decode_indices(p, p_end, entry.first, entry.count, vertex_count, mesh.quads);
+                break;
+            case kSolidsBlock:
+                mesh.solids = decode_solids(p, p_end, size_t(header.face_count));
+                break;
+            }
+        }
+    }, options_.num_threads);
+    stats_.records_parsed = table.size();
+    timer.lap("decode");
+
+    if (options_.weld_vertices) {
+        weld_vertices(mesh, options_.weld_tolerance);
+        timer.lap("weld");
+    }
+    return mesh;
+}
+
+} // namespace cfd
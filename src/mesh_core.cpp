@@ -0,0 +1,471 @@
+#include "mesh_core.hpp"
+#include "parallel_utils.hpp"
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace cfd {
+
+namespace {
+
+// Faces per parallel chunk for the per-face passes
+constexpr size_t kFaceGrain = 1 << 14;
+
+// Keys per parallel chunk for the radix sort and run-length passes
+constexpr size_t kSortGrain = 1 << 16;
+
+// Radix sort digit width: 11 bits covers a 22-bit vertex index pair (4M
+// vertices) in four passes while the per-chunk histograms stay in L1
+constexpr unsigned kRadixBits = 11;
+constexpr size_t kRadixBuckets = size_t(1) << kRadixBits;
+constexpr uint64_t kRadixMask = kRadixBuckets - 1;
+
+void check_index_range(size_t num_faces) {
+    if (num_faces > size_t(std::numeric_limits<int32_t>::max()) / 3) {
+        throw std::runtime_error("Mesh has too many faces for int32 incidence tables");
+    }
+}
+
+// Returns the cached value, building it under the cache lock on first use
+template <typename T, typename Build>
+const T& cached_value(std::mutex& mutex, std::unique_ptr<T>& slot, Build build) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!slot) {
+        slot.reset(new T(build()));
+    }
+    return *slot;
+}
+
+} // namespace
+
+struct Mesh::Cache {
+    std::mutex mutex;
+    std::unique_ptr<EdgeTopology> edges;
+    std::unique_ptr<Incidence> vertex_faces;
+    std::unique_ptr<std::vector<AABB>> face_boxes;
+    std::unique_ptr<std::vector<Vector3d>> face_normals;
+};
+
+AABB triangle_aabb(const Triangle& tri) {
+    AABB box;
+    for (const Vector3d& v : tri.vertices) {
+        box.expand(v);
+    }
+    return box;
+}
+
+void radix_sort_pairs(std::vector<uint64_t>& keys, std::vector<int32_t>& values,
+                      unsigned num_threads) {
+    if (keys.size() != values.size()) {
+        throw std::runtime_error("radix_sort_pairs: key and value arrays differ in length");
+    }
+    const size_t n = keys.size();
+    if (n < 2) {
+        return;
+    }
+    const size_t chunks = parallel_chunk_count(n, kSortGrain, num_threads);
+
+    // Bits that differ between any two keys; a kRadixBits-wide digit
+    // without such bits is the same in every key, so its pass is skipped
+    std::vector<uint64_t> any_set(chunks, 0), all_set(chunks, ~uint64_t(0));
+    parallel_for_chunks(0, n, kSortGrain, [&](size_t c, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            any_set[c] |= keys[i];
+            all_set[c] &= keys[i];
+        }
+    }, num_threads);
+    uint64_t varying = 0, constant = ~uint64_t(0);
+    for (size_t c = 0; c < chunks; ++c) {
+        varying |= any_set[c];
+        constant &= all_set[c];
+    }
+    varying &= ~constant;
+
+    std::vector<uint64_t> key_buffer(n);
+    std::vector<int32_t> value_buffer(n);
+    std::vector<std::array<size_t, kRadixBuckets>> buckets(chunks);
+    for (unsigned shift = 0; shift < 64; shift += kRadixBits) {
+        if (((varying >> shift) & kRadixMask) == 0) {
+            continue;
+        }
+        parallel_for_chunks(0, n, kSortGrain, [&](size_t c, size_t begin, size_t end) {
+            std::array<size_t, kRadixBuckets>& count = buckets[c];
+            count.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                ++count[(keys[i] >> shift) & kRadixMask];
+            }
+        }, num_threads);
+        // Digit-major, chunk-minor prefix sum: chunk c writes each digit after
+        // the same digit of chunks 0..c-1, which keeps the sort stable
+        size_t offset = 0;
+        for (size_t digit = 0; digit < kRadixBuckets; ++digit) {
+            for (size_t c = 0; c < chunks; ++c) {
+                const size_t count = buckets[c][digit];
+                buckets[c][digit] = offset;
+                offset += count;
+            }
+        }
+        parallel_for_chunks(0, n, kSortGrain, [&](size_t c, size_t begin, size_t end) {
+            std::array<size_t, kRadixBuckets>& next = buckets[c];
+            for (size_t i = begin; i < end; ++i) {
+                const size_t slot = next[(keys[i] >> shift) & kRadixMask]++;
+                key_buffer[slot] = keys[i];
+                value_buffer[slot] = values[i];
+            }
+        }, num_threads);
+        keys.swap(key_buffer);
+        values.swap(value_buffer);
+    }
+}
+
+EdgeTopology build_edge_topology(const int32_t* faces, size_t num_faces) {
+    check_index_range(num_faces);
+    const size_t num_half_edges = num_faces * 3;
+
+    // Sort keys hold the (min, max) pair in 2 * index_bits bits instead of
+    // edge_key's two 32-bit halves, so the radix sort skips more digits
+    uint32_t max_index = 0;
+    for (size_t h = 0; h < num_half_edges; ++h) {
+        max_index = std::max(max_index, uint32_t(faces[h]));
+    }
+    unsigned index_bits = 1;
+    while (index_bits < 32 && (max_index >> index_bits) != 0) {
+        ++index_bits;
+    }
+    const uint64_t low_mask = (uint64_t(1) << index_bits) - 1;
+
+    // (sort key, half-edge id) pairs; the stable sort groups the uses of each
+    // edge and keeps them in face order
+    std::vector<uint64_t> keys(num_half_edges);
+    std::vector<int32_t> half_edges(num_half_edges);
+    parallel_for(0, num_faces, kFaceGrain, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            for (size_t k = 0; k < 3; ++k) {
+                const size_t h = f * 3 + k;
+                const uint64_t key = edge_key(faces[h], faces[f * 3 + (k + 1) % 3]);
+                keys[h] = (uint64_t(edge_key_first(key)) << index_bits) | uint64_t(edge_key_second(key));
+                half_edges[h] = int32_t(h);
+            }
+        }
+    });
+    radix_sort_pairs(keys, half_edges);
+
+    // Run-length grouping: count the runs starting in each chunk, then each
+    // chunk numbers its edges from the prefix sum of the earlier chunks
+    auto run_start = [&](size_t i) { return i == 0 || keys[i] != keys[i - 1]; };
+    const size_t chunks = parallel_chunk_count(num_half_edges, kSortGrain);
+    std::vector<size_t> first_edge(chunks + 1, 0);
+    parallel_for_chunks(0, num_half_edges, kSortGrain, [&](size_t c, size_t begin, size_t end) {
+        size_t runs = 0;
+        for (size_t i = begin; i < end; ++i) {
+            runs += run_start(i) ? 1 : 0;
+        }
+        first_edge[c + 1] = runs;
+    });
+    for (size_t c = 0; c < chunks; ++c) {
+        first_edge[c + 1] += first_edge[c];
+    }
+    const size_t num_edges = first_edge[chunks];
+
+    EdgeTopology topology;
+    topology.keys.resize(num_edges);
+    topology.edge_faces.offsets.resize(num_edges + 1);
+    topology.edge_faces.indices.resize(num_half_edges);
+    topology.face_edges.resize(num_half_edges);
+    parallel_for_chunks(0, num_half_edges, kSortGrain, [&](size_t c, size_t begin, size_t end) {
+        size_t next_edge = first_edge[c];
+        for (size_t i = begin; i < end; ++i) {
+            if (run_start(i)) {
+                topology.keys[next_edge] = (keys[i] >> index_bits << 32) | (keys[i] & low_mask);
+                topology.edge_faces.offsets[next_edge] = int32_t(i);
+                ++next_edge;
+            }
+            topology.edge_faces.indices[i] = half_edges[i] / 3;
+            topology.face_edges[size_t(half_edges[i])] = int32_t(next_edge - 1);
+        }
+    });
+    topology.edge_faces.offsets[num_edges] = int32_t(num_half_edges);
+    return topology;
+}
+
+namespace {
+
+std::vector<int32_t> edges_where(const EdgeTopology& topology, bool (*keep)(size_t faces)) {
+    std::vector<int32_t> ids;
+    for (size_t e = 0; e < topology.num_edges(); ++e) {
+        if (keep(topology.edge_faces.count(e))) {
+            ids.push_back(int32_t(e));
+        }
+    }
+    return ids;
+}
+
+} // namespace
+
+std::vector<int32_t> free_edges(const EdgeTopology& topology) {
+    return edges_where(topology, [](size_t faces) { return faces == 1; });
+}
+
+std::vector<int32_t> non_manifold_edges(const EdgeTopology& topology) {
+    return edges_where(topology, [](size_t faces) { return faces > 2; });
+}
+
+BoundaryLoops boundary_loops(const Mesh& mesh) {
+    const EdgeTopology& topology = mesh.edges();
+    std::vector<int32_t> boundary;
+    for (int32_t e : free_edges(topology)) {
+        const uint64_t key = topology.keys[size_t(e)];
+        if (edge_key_first(key) != edge_key_second(key)) {  // Edges of degenerate faces
+            boundary.push_back(e);
+        }
+    }
+    auto endpoint = [&](size_t i, int k) {
+        const uint64_t key = topology.keys[size_t(boundary[i])];
+        return k == 0 ? edge_key_first(key) : edge_key_second(key);
+    };
+
+    // Vertex -> boundary edge incidence (counting sort)
+    const size_t num_vertices = mesh.num_vertices();
+    std::vector<int32_t> offsets(num_vertices + 1, 0);
+    for (size_t i = 0; i < boundary.size(); ++i) {
+        ++offsets[size_t(endpoint(i, 0)) + 1];
+        ++offsets[size_t(endpoint(i, 1)) + 1];
+    }
+    for (size_t v = 0; v < num_vertices; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<int32_t> incident(boundary.size() * 2);
+    std::vector<int32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < boundary.size(); ++i) {
+        incident[size_t(cursor[size_t(endpoint(i, 0))]++)] = int32_t(i);
+        incident[size_t(cursor[size_t(endpoint(i, 1))]++)] = int32_t(i);
+    }
+
+    // Each vertex's cursor only moves forward past used edges, so all walks
+    // together visit every incidence once
+    std::vector<uint8_t> used(boundary.size(), 0);
+    cursor.assign(offsets.begin(), offsets.end() - 1);
+    auto next_edge = [&](int32_t v) -> int32_t {
+        int32_t& slot = cursor[size_t(v)];
+        while (slot < offsets[size_t(v) + 1] && used[size_t(incident[size_t(slot)])]) {
+            ++slot;
+        }
+        return slot < offsets[size_t(v) + 1] ? incident[size_t(slot)] : -1;
+    };
+
+    std::vector<std::vector<int32_t>> walks;
+    std::vector<uint8_t> closed;
+    auto walk_from = [&](int32_t start) {
+        int32_t i;
+        while ((i = next_edge(start)) >= 0) {
+            std::vector<int32_t> walk(1, start);
+            bool is_closed = false;
+            for (int32_t v = start; i >= 0; i = next_edge(v)) {
+                used[size_t(i)] = 1;
+                v = endpoint(size_t(i), 0) == v ? endpoint(size_t(i), 1) : endpoint(size_t(i), 0);
+                if (v == start) {
+                    is_closed = true;
+                    break;
+                }
+                walk.push_back(v);
+            }
+            walks.push_back(std::move(walk));
+            closed.push_back(is_closed ? 1 : 0);
+        }
+    };
+    for (size_t v = 0; v < num_vertices; ++v) {
+        if ((offsets[v + 1] - offsets[v]) % 2 == 1) {
+            walk_from(int32_t(v));
+        }
+    }
+    for (size_t v = 0; v < num_vertices; ++v) {
+        walk_from(int32_t(v));
+    }
+
+    // Orient each walk along its first edge's half-edge in the owning face
+    for (size_t r = 0; r < walks.size(); ++r) {
+        std::vector<int32_t>& walk = walks[r];
+        const uint64_t key = edge_key(walk[0], walk[1]);
+        const size_t e = size_t(std::lower_bound(topology.keys.begin(), topology.keys.end(), key) -
+                                topology.keys.begin());
+        const std::array<int32_t, 3> face = mesh.face(size_t(*topology.edge_faces.begin(e)));
+        for (size_t k = 0; k < 3; ++k) {
+            if (face[k] == walk[1] && face[(k + 1) % 3] == walk[0]) {
+                // Closed loops keep their start vertex, open chains swap ends
+                std::reverse(walk.begin() + (closed[r] ? 1 : 0), walk.end());
+                break;
+            }
+        }
+    }
+
+    const size_t count = walks.size();
+    std::vector<double> perimeter(count, 0.0), area(count, 0.0);
+    std::vector<AABB> boxes(count);
+    for (size_t r = 0; r < count; ++r) {
+        const std::vector<int32_t>& walk = walks[r];
+        const Vector3d origin = mesh.vertex(size_t(walk[0]));
+        Vector3d vector_area;
+        const size_t edges = walk.size() - (closed[r] ? 0 : 1);
+        for (size_t k = 0; k < walk.size(); ++k) {
+            boxes[r].expand(mesh.vertex(size_t(walk[k])));
+        }
+        for (size_t k = 0; k < edges; ++k) {
+            const Vector3d a = mesh.vertex(size_t(walk[k]));
+            const Vector3d b = mesh.vertex(size_t(walk[(k + 1) % walk.size()]));
+            perimeter[r] += (b - a).norm();
+            vector_area = vector_area + (a - origin).cross(b - origin);
+        }
+        // Open chains are closed by the segment between their ends
+        area[r] = 0.5 * vector_area.norm();
+    }
+
+    std::vector<size_t> order(count);
+    for (size_t r = 0; r < count; ++r) order[r] = r;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return perimeter[a] > perimeter[b]; });
+
+    BoundaryLoops result;
+    result.loops.offsets.reserve(count + 1);
+    result.loops.offsets.push_back(0);
+    for (size_t r : order) {
+        result.loops.indices.insert(result.loops.indices.end(), walks[r].begin(), walks[r].end());
+        result.loops.offsets.push_back(int32_t(result.loops.indices.size()));
+        result.closed.push_back(closed[r]);
+        result.perimeter.push_back(perimeter[r]);
+        result.area.push_back(area[r]);
+        result.boxes.push_back(boxes[r]);
+    }
+    return result;
+}
+
+Mesh::Mesh() {
+    init_cache();
+}
+
+Mesh::Mesh(std::vector<double> x, std::vector<double> y, std::vector<double> z,
+           std::vector<int32_t> faces)
+    : x_(std::move(x)), y_(std::move(y)), z_(std::move(z)), faces_(std::move(faces)) {
+    if (x_.size() != y_.size() || x_.size() != z_.size()) {
+        throw std::runtime_error("Vertex coordinate arrays differ in length");
+    }
+    if (faces_.size() % 3 != 0) {
+        throw std::runtime_error("Face index array length is not a multiple of 3");
+    }
+    validate_faces();
+    init_cache();
+}
+
+void Mesh::init_cache() {
+    cache_ = std::make_shared<Cache>();
+}
+
+void Mesh::validate_faces() const {
+    const uint64_t n = x_.size();
+    for (size_t i = 0; i < faces_.size(); ++i) {
+        // Negative indices wrap to large unsigned values and fail the same test
+        if (uint64_t(uint32_t(faces_[i])) >= n) {
+            throw_bad_face_index(i / 3, std::to_string(faces_[i]), x_.size());
+        }
+    }
+}
+
+void Mesh::throw_bad_face_index(size_t face, const std::string& index, size_t num_vertices) {
+    throw std::runtime_error("Face " + std::to_string(face) + " references vertex " + index +
+                             " but the mesh has " + std::to_string(num_vertices) + " vertices");
+}
+
+AABB Mesh::bounds() const {
+    AABB box;
+    for (size_t i = 0; i < x_.size(); ++i) {
+        box.expand(vertex(i));
+    }
+    return box;
+}
+
+const EdgeTopology& Mesh::edges() const {
+    return cached_value(cache_->mutex, cache_->edges,
+                        [this]() { return build_edge_topology(faces_.data(), num_faces()); });
+}
+
+const Incidence& Mesh::vertex_faces() const {
+    return cached_value(cache_->mutex, cache_->vertex_faces, [this]() {
+        check_index_range(num_faces());
+        const size_t num_corners = faces_.size();
+        const uint64_t unused = num_vertices();
+
+        // (vertex, face) corner pairs, radix sorted by vertex; the stable sort
+        // keeps each vertex's faces ascending. A vertex repeated within a
+        // degenerate face lists that face once: the repeats get the key
+        // `unused`, sort last and are dropped.
+        std::vector<uint64_t> keys(num_corners);
+        std::vector<int32_t> corner_faces(num_corners);
+        parallel_for(0, num_faces(), kFaceGrain, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                const int32_t* face = &faces_[f * 3];
+                for (size_t k = 0; k < 3; ++k) {
+                    const bool repeated = (k >= 1 && face[k] == face[0]) || (k >= 2 && face[k] == face[1]);
+                    keys[f * 3 + k] = repeated ? unused : uint64_t(uint32_t(face[k]));
+                    corner_faces[f * 3 + k] = int32_t(f);
+                }
+            }
+        });
+        radix_sort_pairs(keys, corner_faces);
+
+        // offsets[v] is the first corner with key >= v: corner i starts the
+        // rows of all vertices in (keys[i - 1], keys[i]]
+        Incidence incidence;
+        incidence.offsets.resize(num_vertices() + 1);
+        parallel_for(0, num_corners + 1, kSortGrain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t first = i == 0 ? 0 : keys[i - 1] + 1;
+                const uint64_t last = i == num_corners ? unused : keys[i];
+                for (uint64_t v = first; v <= last; ++v) {
+                    incidence.offsets[size_t(v)] = int32_t(i);
+                }
+            }
+        });
+        corner_faces.resize(size_t(incidence.offsets.back()));
+        incidence.indices = std::move(corner_faces);
+        return incidence;
+    });
+}
+
+const std::vector<AABB>& Mesh::face_boxes() const {
+    return cached_value(cache_->mutex, cache_->face_boxes, [this]() {
+        std::vector<AABB> boxes(num_faces());
+        parallel_for(0, num_faces(), kFaceGrain, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                boxes[f] = face_bounds(f);
+            }
+        });
+        return boxes;
+    });
+}
+
+const std::vector<Vector3d>& Mesh::face_normals() const {
+    return cached_value(cache_->mutex, cache_->face_normals, [this]() {
+        std::vector<Vector3d> normals(num_faces());
+        parallel_for(0, num_faces(), kFaceGrain, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                // Exact-zero guard only: a 0.1 mm face of a mesh in metres has
+                // |n| ~ 1e-8 and still gets its unit normal
+                normals[f] = triangle(f).normal();
+            }
+        });
+        return normals;
+    });
+}
+
+std::vector<std::string> Mesh::cached() const {
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    std::vector<std::string> names;
+    if (cache_->edges) names.push_back("edges");
+    if (cache_->vertex_faces) names.push_back("vertex_faces");
+    if (cache_->face_boxes) names.push_back("face_boxes");
+    if (cache_->face_normals) names.push_back("face_normals");
+    return names;
+}
+
+} // namespace cfd
@@ -0,0 +1,305 @@
+#ifndef MESH_CORE_HPP
+#define MESH_CORE_HPP
+
+// Geometry primitives and the triangle mesh container shared by the reader
+// and every detector module. Kept free of Eigen and pybind11 so it builds
+// into one static library linked by all extensions.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cfd {
+
+// Absolute tolerance of isZero() and divide_or_zero()
+constexpr double kAlmostZero = 1e-8;
+
+struct Vector3d {
+    double x, y, z;
+
+    Vector3d() : x(0), y(0), z(0) {}
+    Vector3d(double x, double y, double z) : x(x), y(y), z(z) {}
+
+    Vector3d operator+(const Vector3d& v) const { return Vector3d(x + v.x, y + v.y, z + v.z); }
+    Vector3d operator-(const Vector3d& v) const { return Vector3d(x - v.x, y - v.y, z - v.z); }
+    Vector3d operator*(double s) const { return Vector3d(x * s, y * s, z * s); }
+
+    // Division by exactly zero yields the zero vector
+    Vector3d operator/(double s) const {
+        if (s == 0.0) {
+            return Vector3d();
+        }
+        return Vector3d(x / s, y / s, z / s);
+    }
+
+    double dot(const Vector3d& v) const { return x * v.x + y * v.y + z * v.z; }
+
+    Vector3d cross(const Vector3d& v) const {
+        return Vector3d(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+    }
+
+    double squared_norm() const { return x * x + y * y + z * z; }
+    double norm() const { return std::sqrt(squared_norm()); }
+
+    Vector3d normalized() const { return *this / norm(); }
+
+    bool isZero(double eps = kAlmostZero) const {
+        return std::abs(x) < eps && std::abs(y) < eps && std::abs(z) < eps;
+    }
+
+    static Vector3d Zero() { return Vector3d(); }
+};
+
+// Division that treats |s| < eps as zero and then yields the zero vector.
+// An absolute cutoff suits the pierced-face separating axis test, where
+// near-degenerate axes must drop out; use operator/ for geometry at any scale.
+inline Vector3d divide_or_zero(const Vector3d& v, double s, double eps = kAlmostZero) {
+    if (std::abs(s) < eps) {
+        return Vector3d();
+    }
+    return Vector3d(v.x / s, v.y / s, v.z / s);
+}
+
+struct Triangle {
+    std::array<Vector3d, 3> vertices;
+
+    Triangle() = default;
+    Triangle(const Vector3d& v0, const Vector3d& v1, const Vector3d& v2) : vertices{{v0, v1, v2}} {}
+
+    Vector3d centroid() const { return (vertices[0] + vertices[1] + vertices[2]) / 3.0; }
+
+    double average_edge_length() const {
+        return ((vertices[1] - vertices[0]).norm() + (vertices[2] - vertices[1]).norm() +
+                (vertices[0] - vertices[2]).norm()) / 3.0;
+    }
+
+    // Unnormalized normal, twice the area in length
+    Vector3d area_normal() const { return (vertices[1] - vertices[0]).cross(vertices[2] - vertices[0]); }
+
+    // Unit normal; the zero vector for a triangle of zero area
+    Vector3d normal() const {
+        Vector3d n = area_normal();
+        double len = n.norm();
+        return len > 0.0 ? n / len : n;
+    }
+
+    double area() const { return 0.5 * area_normal().norm(); }
+};
+
+// Axis-aligned bounding box. A default constructed box is empty and grows
+// with expand().
+struct AABB {
+    Vector3d min;
+    Vector3d max;
+
+    AABB()
+        : min(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+              std::numeric_limits<double>::max()),
+          max(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+              std::numeric_limits<double>::lowest()) {}
+    AABB(const Vector3d& min_point, const Vector3d& max_point) : min(min_point), max(max_point) {}
+
+    bool empty() const { return min.x > max.x; }
+
+    void expand(const Vector3d& p) {
+        min.x = std::fmin(min.x, p.x);
+        min.y = std::fmin(min.y, p.y);
+        min.z = std::fmin(min.z, p.z);
+        max.x = std::fmax(max.x, p.x);
+        max.y = std::fmax(max.y, p.y);
+        max.z = std::fmax(max.z, p.z);
+    }
+
+    void expand(const AABB& box) {
+        expand(box.min);
+        expand(box.max);
+    }
+
+    bool intersects(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    Vector3d center() const { return (min + max) * 0.5; }
+    Vector3d extent() const { return max - min; }
+};
+
+AABB triangle_aabb(const Triangle& tri);
+
+// Undirected edge (a, b) packed into one 64-bit key with the smaller vertex
+// index in the high half, so keys order like (min, max) pairs
+inline uint64_t edge_key(int32_t a, int32_t b) {
+    const uint32_t lo = uint32_t(a < b ? a : b);
+    const uint32_t hi = uint32_t(a < b ? b : a);
+    return (uint64_t(lo) << 32) | hi;
+}
+
+inline int32_t edge_key_first(uint64_t key) { return int32_t(key >> 32); }
+inline int32_t edge_key_second(uint64_t key) { return int32_t(key & 0xffffffffu); }
+
+// splitmix64 finalizer; std::hash of an integer is the identity on common
+// standard libraries, which clusters the packed keys in a few buckets
+struct EdgeKeyHash {
+    size_t operator()(uint64_t key) const {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ull;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        return size_t(key);
+    }
+};
+
+// Compressed sparse rows: row r holds indices[offsets[r] .. offsets[r + 1])
+struct Incidence {
+    std::vector<int32_t> offsets;
+    std::vector<int32_t> indices;
+
+    size_t rows() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t count(size_t r) const { return size_t(offsets[r + 1] - offsets[r]); }
+    const int32_t* begin(size_t r) const { return indices.data() + offsets[r]; }
+    const int32_t* end(size_t r) const { return indices.data() + offsets[r + 1]; }
+};
+
+// Unique undirected edges of a triangle mesh
+struct EdgeTopology {
+    std::vector<uint64_t> keys;       // edge_key of each edge, ascending
+    Incidence edge_faces;             // Faces using each edge, ascending
+    std::vector<int32_t> face_edges;  // Edge ids of (v0,v1), (v1,v2), (v2,v0) for each face
+
+    size_t num_edges() const { return keys.size(); }
+};
+
+// Builds the edge tables of num_faces row-major index triples: packs every
+// half-edge into an edge_key, radix sorts the keys and run-length groups them
+EdgeTopology build_edge_topology(const int32_t* faces, size_t num_faces);
+
+// Ids of the edges used by exactly one face (free / boundary edges)
+std::vector<int32_t> free_edges(const EdgeTopology& topology);
+
+// Ids of the edges shared by more than two faces (non-manifold edges)
+std::vector<int32_t> non_manifold_edges(const EdgeTopology& topology);
+
+// Stable parallel LSD radix sort of keys, applying the same permutation to
+// values (11-bit digits). Digits that are equal in every key are skipped, so
+// keys built from small vertex indices need only a few passes.
+void radix_sort_pairs(std::vector<uint64_t>& keys, std::vector<int32_t>& values,
+                      unsigned num_threads = 0);
+
+class Mesh;
+
+// Free edges chained into ordered vertex sequences. Closed loops list each
+// vertex once (the closing edge is implied); open chains run end to end.
+// Loops are sorted by perimeter, largest first.
+struct BoundaryLoops {
+    Incidence loops;               // Vertex sequence of each loop / chain
+    std::vector<uint8_t> closed;   // 1 for closed loops, 0 for open chains
+    std::vector<double> perimeter;
+    std::vector<double> area;      // Estimated hole area: norm of the polygon's vector area
+    std::vector<AABB> boxes;
+
+    size_t size() const { return closed.size(); }
+    size_t edge_count(size_t r) const { return loops.count(r) - (closed[r] ? 0 : 1); }
+};
+
+// Walks the free edges of the mesh into loops in time linear in their
+// number. Open chains start at vertices with an odd number of free edges;
+// a vertex shared by several loops may appear in one walk more than once.
+// Loops follow the winding of the faces along their first edge.
+BoundaryLoops boundary_loops(const Mesh& mesh);
+
+// Triangle mesh with structure-of-arrays vertex coordinates (double) and
+// int32 face indices stored as consecutive triples. Built once from caller
+// buffers and then shared read-only by the detectors. Face indices are
+// validated on construction.
+//
+// Derived structures (edges, incidences, face boxes and normals) are built on
+// first use and cached, so any number of detectors share one computation.
+// The accessors are thread-safe; copies of a Mesh share the cache.
+class Mesh {
+public:
+    Mesh();
+
+    // Copies a row-major (num_vertices x 3) coordinate buffer and a row-major
+    // (num_faces x 3) index buffer of any arithmetic / integer type
+    template <typename Real, typename Index>
+    Mesh(const Real* xyz, size_t num_vertices, const Index* faces, size_t num_faces)
+        : x_(num_vertices), y_(num_vertices), z_(num_vertices), faces_(num_faces * 3) {
+        for (size_t i = 0; i < num_vertices; ++i) {
+            x_[i] = double(xyz[i * 3]);
+            y_[i] = double(xyz[i * 3 + 1]);
+            z_[i] = double(xyz[i * 3 + 2]);
+        }
+        // Range-checked in the source type: narrowing first would wrap an int64
+        // index of 2^32 + 5 to 5 and let it pass
+        const uint64_t limit =
+            std::min<uint64_t>(num_vertices, uint64_t(std::numeric_limits<int32_t>::max()) + 1);
+        for (size_t i = 0; i < num_faces * 3; ++i) {
+            const Index index = faces[i];
+            if ((std::is_signed<Index>::value && int64_t(index) < 0) || uint64_t(index) >= limit) {
+                throw_bad_face_index(i / 3, std::to_string(index), num_vertices);
+            }
+            faces_[i] = int32_t(index);
+        }
+        init_cache();
+    }
+
+    Mesh(std::vector<double> x, std::vector<double> y, std::vector<double> z,
+         std::vector<int32_t> faces);
+
+    size_t num_vertices() const { return x_.size(); }
+    size_t num_faces() const { return faces_.size() / 3; }
+
+    const std::vector<double>& x() const { return x_; }
+    const std::vector<double>& y() const { return y_; }
+    const std::vector<double>& z() const { return z_; }
+    const std::vector<int32_t>& faces() const { return faces_; }
+
+    Vector3d vertex(size_t i) const { return Vector3d(x_[i], y_[i], z_[i]); }
+
+    std::array<int32_t, 3> face(size_t f) const {
+        return {{faces_[f * 3], faces_[f * 3 + 1], faces_[f * 3 + 2]}};
+    }
+
+    Triangle triangle(size_t f) const {
+        return Triangle(vertex(size_t(faces_[f * 3])), vertex(size_t(faces_[f * 3 + 1])),
+                        vertex(size_t(faces_[f * 3 + 2])));
+    }
+
+    AABB face_bounds(size_t f) const { return triangle_aabb(triangle(f)); }
+
+    // Bounds of all vertices (empty box for a mesh without vertices)
+    AABB bounds() const;
+
+    const EdgeTopology& edges() const;
+    const Incidence& vertex_faces() const;              // Faces around each vertex, ascending
+    const std::vector<AABB>& face_boxes() const;
+    const std::vector<Vector3d>& face_normals() const;  // Unit normals, zero for zero-area faces
+
+    // Names of the derived structures built so far ("edges", "vertex_faces",
+    // "face_boxes", "face_normals")
+    std::vector<std::string> cached() const;
+
+private:
+    struct Cache;
+
+    void validate_faces() const;
+    [[noreturn]] static void throw_bad_face_index(size_t face, const std::string& index, size_t num_vertices);
+    void init_cache();
+
+    std::vector<double> x_, y_, z_;
+    std::vector<int32_t> faces_;
+    std::shared_ptr<Cache> cache_;
+};
+
+} // namespace cfd
+
+#endif // MESH_CORE_HPP
@@ -0,0 +1,97 @@
+#ifndef MESH_CORE_PY_HPP
+#define MESH_CORE_PY_HPP
+
+// NumPy <-> cfd::Mesh conversions shared by the detector modules
+
+#include "mesh_core.hpp"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cfd {
+
+namespace detail {
+
+inline void check_rows_of_3(const pybind11::array& array, const char* name) {
+    if (array.ndim() != 2 || array.shape(1) != 3) {
+        throw std::runtime_error(std::string(name) + " array must be a 2D array with shape (n, 3)");
+    }
+}
+
+template <typename Real>
+Mesh mesh_from_typed_vertices(const Real* xyz, size_t num_vertices, const pybind11::array& faces) {
+    namespace py = pybind11;
+    const size_t num_faces = size_t(faces.shape(0));
+    if (py::isinstance<py::array_t<int32_t>>(faces)) {
+        auto f = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(faces);
+        if (!f) throw py::error_already_set();
+        return Mesh(xyz, num_vertices, f.data(), num_faces);
+    }
+    // Other index types widen to int64, so the Mesh range check sees an
+    // unsigned index of 2^32 + 5 rather than a wrapped 5
+    auto f = py::array_t<int64_t, py::array::c_style | py::array::forcecast>::ensure(faces);
+    if (!f) throw py::error_already_set();
+    return Mesh(xyz, num_vertices, f.data(), num_faces);
+}
+
+} // namespace detail
+
+// Builds a Mesh from an (n, 3) vertex array and an (m, 3) face array.
+// float32 / float64 vertices and int32 / int64 faces are read in place when
+// C-contiguous; other dtypes are converted once (faces to int64).
+inline Mesh mesh_from_arrays(const pybind11::array& vertices, const pybind11::array& faces) {
+    namespace py = pybind11;
+    detail::check_rows_of_3(vertices, "Vertices");
+    detail::check_rows_of_3(faces, "Faces");
+    const size_t num_vertices = size_t(vertices.shape(0));
+    if (py::isinstance<py::array_t<float>>(vertices)) {
+        auto v = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(vertices);
+        if (!v) throw py::error_already_set();
+        return detail::mesh_from_typed_vertices(v.data(), num_vertices, faces);
+    }
+    auto v = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(vertices);
+    if (!v) throw py::error_already_set();
+    return detail::mesh_from_typed_vertices(v.data(), num_vertices, faces);
+}
+
+// Copies a vector into a new 1D NumPy array
+template <typename T>
+pybind11::array_t<T> copy_to_array(const std::vector<T>& values) {
+    pybind11::array_t<T> array(pybind11::ssize_t(values.size()));
+    std::copy(values.begin(), values.end(), array.mutable_data());
+    return array;
+}
+
+// Boundary loops as a dict of NumPy arrays: loop r visits
+// vertices[offsets[r]:offsets[r + 1]]; bbox rows are min xyz, max xyz
+inline pybind11::dict boundary_loops_to_dict(const BoundaryLoops& result) {
+    namespace py = pybind11;
+    const py::ssize_t count = py::ssize_t(result.size());
+    py::array_t<bool> closed(count);
+    py::array_t<int32_t> edge_count(count);
+    py::array_t<double> bbox({count, py::ssize_t(6)});
+    for (size_t r = 0; r < result.size(); ++r) {
+        closed.mutable_data()[r] = result.closed[r] != 0;
+        edge_count.mutable_data()[r] = int32_t(result.edge_count(r));
+        const AABB& box = result.boxes[r];
+        double* row = bbox.mutable_data() + r * 6;
+        row[0] = box.min.x; row[1] = box.min.y; row[2] = box.min.z;
+        row[3] = box.max.x; row[4] = box.max.y; row[5] = box.max.z;
+    }
+    py::dict loops;
+    loops["offsets"] = copy_to_array(result.loops.offsets);
+    loops["vertices"] = copy_to_array(result.loops.indices);
+    loops["closed"] = closed;
+    loops["edge_count"] = edge_count;
+    loops["perimeter"] = copy_to_array(result.perimeter);
+    loops["area"] = copy_to_array(result.area);
+    loops["bbox"] = bbox;
+    return loops;
+}
+
+} // namespace cfd
+
+#endif // MESH_CORE_PY_HPP
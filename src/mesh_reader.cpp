@@ -1,250 +1,1243 @@
 #include "mesh_reader.hpp"
-#include <fstream>
-#include <sstream>
-#include <unordered_map>
+#include "mapped_file.hpp"
+#include "mesh_cache.hpp"
+#include "parallel_utils.hpp"
+#include "phase_timer.hpp"
+#include "text_parse.hpp"
 #include <stdexcept>
+#include <unordered_map>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <utility>
 
 namespace cfd {
 
-bool STLReader::is_binary(const std::vector<char>& header) {
-    return std::any_of(header.begin(), header.end(),
-                      [](char c) { return !std::isprint(c) && !std::isspace(c); });
+namespace {
+
+uint64_t mix_hash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hash_cell(int64_t cx, int64_t cy, int64_t cz) {
+    uint64_t h = mix_hash(uint64_t(cx));
+    h = mix_hash(h ^ uint64_t(cy));
+    return mix_hash(h ^ uint64_t(cz));
+}
+
+int64_t grid_coordinate(float value, float inv_cell) {
+    const double scaled = std::floor(double(value) * inv_cell);
+    const double limit = 4.0e18;
+    if (!(scaled > -limit)) return int64_t(-limit);
+    if (!(scaled < limit)) return int64_t(limit);
+    return int64_t(scaled);
+}
+
+int64_t exact_coordinate(float value) {
+    value += 0.0f;  // fold -0.0 onto +0.0
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
 }
 
-MeshData STLReader::read_binary(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Cannot open file: " + file_path);
+} // namespace
+
+void weld_vertices(MeshData& mesh, float tolerance) {
+    const Eigen::Index vertex_count = mesh.vertices.rows();
+    const Eigen::Index face_count = mesh.faces.rows();
+    if (vertex_count == 0 || face_count == 0) {
+        return;
+    }
+
+    // Vertices are bucketed on a grid of cell size `tolerance` (or by their exact
+    // bit pattern when tolerance is 0) in an open-addressing table holding the
+    // ids of the welded vertices. A vertex is merged into the first welded
+    // vertex within tolerance found in its own or a neighbouring cell.
+    const bool exact = !(tolerance > 0.0f);
+    const float inv_cell = exact ? 0.0f : 1.0f / tolerance;
+    const float tolerance_sq = tolerance * tolerance;
+
+    size_t capacity = 16;
+    while (capacity < size_t(vertex_count) * 2) {
+        capacity <<= 1;
     }
+    const size_t mask = capacity - 1;
+    std::vector<int> slot_ids(capacity, -1);
+    std::vector<uint64_t> slot_hashes(capacity);
+
+    std::vector<float> welded;
+    welded.reserve(size_t(vertex_count) * 3);
+    std::vector<int> remap(vertex_count, -1);
+
+    auto matches = [&](int id, float x, float y, float z) {
+        const float* w = &welded[size_t(id) * 3];
+        if (exact) {
+            return w[0] == x && w[1] == y && w[2] == z;
+        }
+        const float dx = w[0] - x, dy = w[1] - y, dz = w[2] - z;
+        return dx * dx + dy * dy + dz * dz <= tolerance_sq;
+    };
 
-    // Skip header
-    file.seekg(80);
+    // Returns the welded id in the cell with hash h, or -1. `free_slot`
+    // receives the slot where a new entry for this cell would be inserted.
+    auto find_in_cell = [&](uint64_t h, float x, float y, float z, size_t& free_slot) {
+        size_t slot = h & mask;
+        while (slot_ids[slot] != -1) {
+            if (slot_hashes[slot] == h && matches(slot_ids[slot], x, y, z)) {
+                return slot_ids[slot];
+            }
+            slot = (slot + 1) & mask;
+        }
+        free_slot = slot;
+        return -1;
+    };
+
+    auto weld = [&](int v) {
+        const float x = mesh.vertices(v, 0);
+        const float y = mesh.vertices(v, 1);
+        const float z = mesh.vertices(v, 2);
+
+        int64_t cx, cy, cz;
+        if (exact) {
+            cx = exact_coordinate(x);
+            cy = exact_coordinate(y);
+            cz = exact_coordinate(z);
+        } else {
+            cx = grid_coordinate(x, inv_cell);
+            cy = grid_coordinate(y, inv_cell);
+            cz = grid_coordinate(z, inv_cell);
+        }
+
+        const uint64_t h = hash_cell(cx, cy, cz);
+        size_t insert_slot = 0;
+        int id = find_in_cell(h, x, y, z, insert_slot);
+
+        if (id < 0 && !exact) {
+            size_t unused;
+            for (int dx = -1; dx <= 1 && id < 0; ++dx) {
+                for (int dy = -1; dy <= 1 && id < 0; ++dy) {
+                    for (int dz = -1; dz <= 1 && id < 0; ++dz) {
+                        if (dx == 0 && dy == 0 && dz == 0) continue;
+                        id = find_in_cell(hash_cell(cx + dx, cy + dy, cz + dz), x, y, z, unused);
+                    }
+                }
+            }
+        }
+
+        if (id < 0) {
+            id = int(welded.size() / 3);
+            welded.push_back(x);
+            welded.push_back(y);
+            welded.push_back(z);
+            slot_ids[insert_slot] = id;
+            slot_hashes[insert_slot] = h;
+        }
+        return id;
+    };
+
+    RowMatrixXi faces(face_count, mesh.faces.cols());
+    for (Eigen::Index f = 0; f < face_count; ++f) {
+        for (Eigen::Index k = 0; k < mesh.faces.cols(); ++k) {
+            const int v = mesh.faces(f, k);
+            if (v < 0 || v >= vertex_count) {
+                throw std::runtime_error("Face " + std::to_string(f) +
+                                         " references invalid vertex " + std::to_string(v));
+            }
+            if (remap[v] < 0) {
+                remap[v] = weld(v);
+            }
+            faces(f, k) = remap[v];
+        }
+    }
+
+    const Eigen::Index welded_count = Eigen::Index(welded.size() / 3);
+    RowMatrixXf vertices(welded_count, 3);
+    for (Eigen::Index i = 0; i < welded_count; ++i) {
+        vertices(i, 0) = welded[size_t(i) * 3];
+        vertices(i, 1) = welded[size_t(i) * 3 + 1];
+        vertices(i, 2) = welded[size_t(i) * 3 + 2];
+    }
+
+    mesh.vertices = std::move(vertices);
+    mesh.faces = std::move(faces);
+}
+
+namespace {
+
+// Slices an already loaded mesh into blocks: vertices, then faces, then quads
+class InMemoryMeshStream : public MeshStream {
+public:
+    InMemoryMeshStream(MeshData mesh, size_t block_size)
+        : mesh_(std::move(mesh)), block_size_(std::max<size_t>(block_size, 1)) {}
+
+    bool next(MeshBlock& block) override {
+        const size_t vertex_count = size_t(mesh_.vertices.rows());
+        const size_t face_count = size_t(mesh_.faces.rows());
+        const size_t quad_count = size_t(mesh_.quads.rows());
+
+        block = MeshBlock();
+        if (cursor_ < vertex_count) {
+            const size_t n = std::min(block_size_, vertex_count - cursor_);
+            block.kind = MeshBlock::Kind::Vertices;
+            block.first = cursor_;
+            block.vertices = mesh_.vertices.middleRows(cursor_, n);
+        } else if (cursor_ < vertex_count + face_count) {
+            const size_t first = cursor_ - vertex_count;
+            const size_t n = std::min(block_size_, face_count - first);
+            block.kind = MeshBlock::Kind::Faces;
+            block.first = first;
+            block.faces = mesh_.faces.middleRows(first, n);
+            if (mesh_.normals.rows() == mesh_.faces.rows()) {
+                block.normals = mesh_.normals.middleRows(first, n);
+            }
+        } else if (cursor_ < vertex_count + face_count + quad_count) {
+            const size_t first = cursor_ - vertex_count - face_count;
+            const size_t n = std::min(block_size_, quad_count - first);
+            block.kind = MeshBlock::Kind::Quads;
+            block.first = first;
+            block.quads = mesh_.quads.middleRows(first, n);
+        } else {
+            return false;
+        }
+        cursor_ += size_t(std::max({block.vertices.rows(), block.faces.rows(), block.quads.rows()}));
+        return true;
+    }
+
+private:
+    MeshData mesh_;
+    size_t block_size_;
+    size_t cursor_ = 0;
+};
+
+// Decodes a binary STL a few triangles at a time: each step yields the
+// vertex block of the next triangles followed by their face block
+class BinaryStlStream : public MeshStream {
+public:
+    BinaryStlStream(MappedFile file, size_t block_size)
+        : file_(std::move(file)),
+          triangles_per_block_(std::max<size_t>(block_size / 3, 1)) {
+        if (file_.size() < 84) {
+            throw std::runtime_error("Binary STL file is truncated: " + file_.path());
+        }
+        uint32_t count;
+        std::memcpy(&count, file_.data() + 80, sizeof(uint32_t));
+        if (file_.size() < 84 + uint64_t(50) * count) {
+            throw std::runtime_error("Binary STL file is truncated: " + file_.path());
+        }
+        triangle_count_ = count;
+    }
+
+    bool next(MeshBlock& block) override {
+        if (has_pending_faces_) {
+            block = std::move(pending_faces_);
+            has_pending_faces_ = false;
+            return true;
+        }
+        if (cursor_ >= triangle_count_) {
+            return false;
+        }
+
+        const size_t n = std::min(triangles_per_block_, triangle_count_ - cursor_);
+        block = MeshBlock();
+        block.kind = MeshBlock::Kind::Vertices;
+        block.first = cursor_ * 3;
+        block.vertices.resize(n * 3, 3);
+
+        pending_faces_ = MeshBlock();
+        pending_faces_.kind = MeshBlock::Kind::Faces;
+        pending_faces_.first = cursor_;
+        pending_faces_.faces.resize(n, 3);
+        pending_faces_.normals.resize(n, 3);
+
+        const char* records = file_.data() + 84 + cursor_ * 50;
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(pending_faces_.normals.data() + i * 3, records + i * 50, 3 * sizeof(float));
+            std::memcpy(block.vertices.data() + i * 9, records + i * 50 + 3 * sizeof(float),
+                        9 * sizeof(float));
+            for (int k = 0; k < 3; ++k) {
+                pending_faces_.faces(i, k) = int((cursor_ + i) * 3 + k);
+            }
+        }
+        file_.release(84 + cursor_ * 50, n * 50);
+
+        cursor_ += n;
+        has_pending_faces_ = true;
+        return true;
+    }
+
+private:
+    MappedFile file_;
+    size_t triangles_per_block_;
+    size_t triangle_count_ = 0;
+    size_t cursor_ = 0;
+    MeshBlock pending_faces_;
+    bool has_pending_faces_ = false;
+};
+
+} // namespace
+
+std::unique_ptr<MeshStream> MeshReader::open_stream(const std::string& file_path,
+                                                    size_t block_size) {
+    return std::make_unique<InMemoryMeshStream>(read(file_path), block_size);
+}
+
+namespace {
+
+// Whitespace-separated tokens of an ASCII STL, tracked only by pointers
+struct StlTokenizer {
+    const char* p;
+    const char* end;
+
+    bool next(const char*& begin, const char*& token_end) {
+        while (p < end && (is_blank(*p) || *p == '\n' || *p == '\f' || *p == '\v')) ++p;
+        if (p == end) return false;
+        begin = p;
+        while (p < end && !is_blank(*p) && *p != '\n' && *p != '\f' && *p != '\v') ++p;
+        token_end = p;
+        return true;
+    }
+
+    // Remainder of the current line without surrounding blanks
+    std::string rest_of_line() {
+        const char* begin = p;
+        while (p < end && *p != '\n') ++p;
+        const char* line_end = p;
+        trim_blanks(begin, line_end);
+        return std::string(begin, line_end);
+    }
+};
+
+bool token_is(const char* begin, const char* end, const char* keyword) {
+    const size_t length = std::strlen(keyword);
+    if (size_t(end - begin) != length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(begin[i])) != keyword[i]) return false;
+    }
+    return true;
+}
+
+[[noreturn]] void throw_ascii_stl_error(const MappedFile& file, const char* at, const char* what) {
+    const size_t line = size_t(std::count(file.data(), at, '\n')) + 1;
+    throw std::runtime_error(std::string("Malformed ASCII STL (") + what + ") at line " +
+                             std::to_string(line) + ": " + file.path());
+}
+
+} // namespace
+
+bool STLReader::is_binary(const MappedFile& file) {
+    // A binary STL is exactly 84 + 50 * count bytes, which also holds for
+    // binaries whose header happens to start with "solid"
+    if (file.size() >= 84) {
+        uint32_t count;
+        std::memcpy(&count, file.data() + 80, sizeof(uint32_t));
+        if (file.size() == 84 + uint64_t(50) * count) {
+            return true;
+        }
+    }
+
+    // Otherwise it is ASCII when the text starts with "solid" or "facet" and
+    // the first KiB holds only text; anything else is treated as a (damaged)
+    // binary so read_binary reports it
+    const size_t probe = std::min<size_t>(file.size(), 1024);
+    const char* p = file.data();
+    const char* const probe_end = p + probe;
+    const bool text_only = std::all_of(p, probe_end, [](char c) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        return u >= 0x20 || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    });
+    if (!text_only) {
+        return false;
+    }
+    StlTokenizer tokens{p, probe_end};
+    const char* begin;
+    const char* end;
+    if (!tokens.next(begin, end)) {
+        return file.size() >= 84;
+    }
+    return !token_is(begin, end, "solid") && !token_is(begin, end, "facet");
+}
+
+MeshData STLReader::read_binary(const MappedFile& file) {
+    // Binary STL layout: 80-byte header, uint32 triangle count, then one
+    // 50-byte record per triangle (normal, three vertices, uint16 attribute).
+    constexpr size_t kHeaderSize = 84;
+    constexpr size_t kRecordSize = 50;
+
+    if (file.size() < kHeaderSize) {
+        throw std::runtime_error("Binary STL file is truncated: " + file.path());
+    }
 
-    // Read number of triangles
     uint32_t triangle_count;
-    file.read(reinterpret_cast<char*>(&triangle_count), sizeof(uint32_t));
+    std::memcpy(&triangle_count, file.data() + 80, sizeof(uint32_t));
+
+    const uint64_t expected_size = kHeaderSize + uint64_t(kRecordSize) * triangle_count;
+    if (file.size() < expected_size) {
+        throw std::runtime_error("Binary STL file declares " + std::to_string(triangle_count) +
+                                 " triangles (" + std::to_string(expected_size) +
+                                 " bytes) but is only " + std::to_string(file.size()) +
+                                 " bytes: " + file.path());
+    }
 
     // Pre-allocate matrices
-    Eigen::MatrixXf vertices(triangle_count * 3, 3);
-    Eigen::MatrixXi faces(triangle_count, 3);
-    Eigen::MatrixXf normals(triangle_count, 3);
-
-    // Read triangles
-    for (uint32_t i = 0; i < triangle_count; ++i) {
-        float normal[3];
-        float v1[3], v2[3], v3[3];
-        uint16_t attribute_byte_count;
-
-        // Read normal
-        file.read(reinterpret_cast<char*>(normal), sizeof(float) * 3);
-        normals.row(i) << normal[0], normal[1], normal[2];
-
-        // Read vertices
-        file.read(reinterpret_cast<char*>(v1), sizeof(float) * 3);
-        file.read(reinterpret_cast<char*>(v2), sizeof(float) * 3);
-        file.read(reinterpret_cast<char*>(v3), sizeof(float) * 3);
-
-        // Store vertices
-        int base_idx = i * 3;
-        vertices.row(base_idx) << v1[0], v1[1], v1[2];
-        vertices.row(base_idx + 1) << v2[0], v2[1], v2[2];
-        vertices.row(base_idx + 2) << v3[0], v3[1], v3[2];
-
-        // Store face indices
-        faces.row(i) << base_idx, base_idx + 1, base_idx + 2;
-
-        // Skip attribute byte count
-        file.read(reinterpret_cast<char*>(&attribute_byte_count), sizeof(uint16_t));
-    }
-
-    return MeshData{vertices, faces, normals};
-}
-
-MeshData STLReader::read_ascii(const std::string& file_path) {
-    std::ifstream file(file_path);
-    if (!file) {
-        throw std::runtime_error("Cannot open file: " + file_path);
-    }
-
-    std::vector<Eigen::Vector3f> vertices_vec;
-    std::vector<Eigen::Vector3i> faces_vec;
-    std::vector<Eigen::Vector3f> normals_vec;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string token;
-        iss >> token;
-
-        if (token == "facet" && iss >> token && token == "normal") {
-            Eigen::Vector3f normal;
-            iss >> normal.x() >> normal.y() >> normal.z();
-            normals_vec.push_back(normal);
-
-            // Skip "outer loop"
-            std::getline(file, line);
-
-            // Read three vertices
-            Eigen::Vector3i face;
-            for (int i = 0; i < 3; ++i) {
-                std::getline(file, line);
-                iss.clear();
-                iss.str(line);
-                iss >> token; // Skip "vertex"
-                
-                Eigen::Vector3f vertex;
-                iss >> vertex.x() >> vertex.y() >> vertex.z();
-                vertices_vec.push_back(vertex);
-                face[i] = vertices_vec.size() - 1;
+    RowMatrixXf vertices(size_t(triangle_count) * 3, 3);
+    RowMatrixXi faces(triangle_count, 3);
+    RowMatrixXf normals(triangle_count, 3);
+
+    // Decode records straight from the mapping, one contiguous range per thread
+    const char* records = file.data() + kHeaderSize;
+    parallel_for(0, triangle_count, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // Row-major storage matches the record layout: normal, then 3 vertices
+            const char* record = records + i * kRecordSize;
+            std::memcpy(normals.data() + i * 3, record, 3 * sizeof(float));
+            std::memcpy(vertices.data() + i * 9, record + 3 * sizeof(float), 9 * sizeof(float));
+
+            const Eigen::Index base_idx = Eigen::Index(i) * 3;
+            faces(i, 0) = int(base_idx);
+            faces(i, 1) = int(base_idx + 1);
+            faces(i, 2) = int(base_idx + 2);
+        }
+    }, options_.num_threads);
+
+    return MeshData{std::move(vertices), std::move(faces), std::move(normals), RowMatrixXi(), {}};
+}
+
+MeshData STLReader::read_ascii(const MappedFile& file) {
+    std::vector<float> coords;
+    std::vector<float> normal_coords;
+    std::vector<SolidRange> solids;
+    size_t face_count = 0;
+    size_t facet_vertices = 0;
+    bool in_facet = false;
+    bool in_solid = false;
+
+    StlTokenizer tokens{file.data(), file.data() + file.size()};
+    const char* begin;
+    const char* end;
+
+    auto read_vector = [&](std::vector<float>& out, const char* what) {
+        for (int k = 0; k < 3; ++k) {
+            float value;
+            if (!tokens.next(begin, end) || !parse_real(begin, end, value)) {
+                throw_ascii_stl_error(file, tokens.p, what);
+            }
+            out.push_back(value);
+        }
+    };
+    auto close_solid = [&]() {
+        if (in_solid) {
+            solids.back().face_count = face_count - solids.back().first_face;
+            in_solid = false;
+        }
+    };
+
+    // Keywords are matched wherever they appear, so the layout of lines and
+    // indentation does not matter; "outer loop" and "endloop" carry no data
+    while (tokens.next(begin, end)) {
+        if (token_is(begin, end, "vertex")) {
+            if (!in_facet || facet_vertices == 3) {
+                throw_ascii_stl_error(file, tokens.p, "vertex outside a triangle facet");
+            }
+            read_vector(coords, "vertex");
+            ++facet_vertices;
+        } else if (token_is(begin, end, "facet")) {
+            if (in_facet) {
+                throw_ascii_stl_error(file, tokens.p, "missing 'endfacet'");
+            }
+            if (!tokens.next(begin, end) || !token_is(begin, end, "normal")) {
+                throw_ascii_stl_error(file, tokens.p, "expected 'normal'");
             }
-            faces_vec.push_back(face);
+            if (!in_solid) {
+                // Facets before any "solid" line form an unnamed solid
+                solids.push_back(SolidRange{std::string(), face_count, 0});
+                in_solid = true;
+            }
+            read_vector(normal_coords, "facet normal");
+            facet_vertices = 0;
+            in_facet = true;
+        } else if (token_is(begin, end, "endfacet")) {
+            if (!in_facet || facet_vertices != 3) {
+                throw_ascii_stl_error(file, tokens.p, "facet without 3 vertices");
+            }
+            in_facet = false;
+            ++face_count;
+        } else if (token_is(begin, end, "solid")) {
+            close_solid();
+            solids.push_back(SolidRange{tokens.rest_of_line(), face_count, 0});
+            in_solid = true;
+        } else if (token_is(begin, end, "endsolid")) {
+            tokens.rest_of_line();
+            close_solid();
+        }
+    }
+    if (in_facet) {
+        throw_ascii_stl_error(file, tokens.p, "missing 'endfacet'");
+    }
+    close_solid();
+    stats_.peak_scratch_bytes = (coords.capacity() + normal_coords.capacity()) * sizeof(float);
+
+    RowMatrixXf vertices = Eigen::Map<const RowMatrixXf>(coords.data(), Eigen::Index(face_count * 3), 3);
+    RowMatrixXf normals = Eigen::Map<const RowMatrixXf>(normal_coords.data(), Eigen::Index(face_count), 3);
+    RowMatrixXi faces(face_count, 3);
+    for (size_t i = 0; i < face_count * 3; ++i) {
+        faces.data()[i] = int(i);
+    }
+
+    return MeshData{std::move(vertices), std::move(faces), std::move(normals), RowMatrixXi(),
+                    std::move(solids)};
+}
+
+MeshData STLReader::read(const std::string& file_path) {
+    stats_ = LoadStats();
+    return read_with_cache(file_path, options_, [&]() {
+        PhaseTimer timer(stats_);
+        MappedFile file(file_path);
+        stats_.bytes_read = file.size();
+        timer.lap("map");
+
+        const bool binary = is_binary(file);
+        MeshData mesh = binary ? read_binary(file) : read_ascii(file);
+        stats_.records_parsed = uint64_t(mesh.faces.rows());
+        timer.lap(binary ? "decode" : "tokenize");
+
+        if (options_.weld_vertices) {
+            weld_vertices(mesh, options_.weld_tolerance);
+            timer.lap("weld");
+        }
+        return mesh;
+    }, &stats_);
+}
+
+std::unique_ptr<MeshStream> STLReader::open_stream(const std::string& file_path,
+                                                   size_t block_size) {
+    // Welding needs the whole mesh, so streams always deliver the raw triangles
+    MappedFile file(file_path);
+    if (is_binary(file)) {
+        return std::make_unique<BinaryStlStream>(std::move(file), block_size);
+    }
+    return std::make_unique<InMemoryMeshStream>(read_ascii(file), block_size);
+}
+
+namespace {
+
+// A field of a bulk data card, as a character range inside the mapped file
+struct TextField {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+};
+
+// Most data fields collected for one card, continuations included
+constexpr int kMaxCardFields = 32;
+
+// A bulk data card with its continuation lines joined into one list of data
+// fields in logical order (field 2 onwards; large-field lines contribute 4
+// fields each, small-field and free-field lines 8)
+struct NasCard {
+    TextField fields[kMaxCardFields];
+    int field_count = 0;
+    bool whitespace_split = false;  // A line ignored the columns, so blank fields were lost
+};
+
+enum class NasCardType { Unsupported, Grid, Ctria3, Ctria6, Cquad4 };
 
-            // Skip "endloop" and "endfacet"
-            std::getline(file, line);
-            std::getline(file, line);
+// Cards collected from the bulk data section, still referring to GRID ids
+struct NasBulkData {
+    std::vector<int> node_ids;          // GRID id of each vertex
+    std::vector<float> coords;          // x, y, z of each vertex
+    std::vector<int> elem_nodes;        // GRID ids of the corners of each element
+    std::vector<uint8_t> elem_corners;  // Corner count of each element (3 or 4)
+    size_t line_count = 0;              // Lines consumed, continuations included
+    size_t card_count = 0;              // Supported cards parsed
+    size_t unsupported_count = 0;       // Cards of other types (first lines only)
+    size_t invalid_count = 0;           // Supported cards with malformed fields
+
+    size_t scratch_bytes() const {
+        return node_ids.capacity() * sizeof(int) + coords.capacity() * sizeof(float) +
+               elem_nodes.capacity() * sizeof(int) + elem_corners.capacity();
+    }
+};
+
+const char* find_line_end(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', size_t(end - p));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+const char* strip_carriage_return(const char* line, const char* line_end) {
+    return (line_end > line && line_end[-1] == '\r') ? line_end - 1 : line_end;
+}
+
+// Continuation lines start with '+' (small field), '*' (large field) or ','
+// (free field), or leave the first 8 columns blank
+bool is_continuation_line(const char* line, const char* end) {
+    const char c = *line;
+    if (c == '+' || c == '*' || c == ',') return true;
+    if (c != ' ') return false;
+
+    const char* p = line;
+    for (int col = 0; col < 8; ++col, ++p) {
+        if (p == end || *p == '\n') return false;
+        if (*p == ',') return true;
+        if (!is_blank(*p)) return false;
+    }
+    for (; p < end && *p != '\n'; ++p) {
+        if (!is_blank(*p)) return true;
+    }
+    return false;
+}
+
+// Returns the start of the first card beginning at or after p: moves to the
+// next line start unless p already is one, then past continuation lines so
+// that a card is never separated from its continuations.
+const char* next_card_start(const char* p, const char* begin, const char* end) {
+    if (p > begin && p[-1] != '\n') {
+        p = find_line_end(p, end);
+        if (p < end) ++p;
+    }
+    while (p < end && is_continuation_line(p, end)) {
+        p = find_line_end(p, end);
+        if (p < end) ++p;
+    }
+    return p;
+}
+
+// Identifies the card from its name (case-insensitive, as free-field decks
+// may be lower case). `large_field` is set for names ending in '*'.
+NasCardType card_type(const char* line, const char* line_end, bool& large_field) {
+    char name[9];
+    int length = 0;
+    const char* p = line;
+    for (; p < line_end && length < 8 && std::isalnum(static_cast<unsigned char>(*p)); ++p) {
+        name[length++] = char(std::toupper(static_cast<unsigned char>(*p)));
+    }
+    name[length] = '\0';
+
+    large_field = (p < line_end && *p == '*');
+    if (large_field) ++p;
+    if (p < line_end && !is_blank(*p) && *p != ',') return NasCardType::Unsupported;
+
+    if (std::strcmp(name, "GRID") == 0) return NasCardType::Grid;
+    if (std::strcmp(name, "CTRIA3") == 0) return NasCardType::Ctria3;
+    if (std::strcmp(name, "CTRIA6") == 0) return NasCardType::Ctria6;
+    if (std::strcmp(name, "CQUAD4") == 0) return NasCardType::Cquad4;
+    return NasCardType::Unsupported;
+}
+
+// Whether the line starts a card, i.e. begins with a name in column 1.
+// Comments ('$'), blank and continuation lines do not, nor do the BEGIN BULK,
+// CEND and ENDDATA delimiters.
+bool is_card_name_line(const char* line, const char* line_end) {
+    if (line == line_end || !std::isalpha(static_cast<unsigned char>(*line))) return false;
+    auto starts_with = [&](const char* word) {
+        const char* p = line;
+        for (; *word && p < line_end; ++word, ++p) {
+            if (std::toupper(static_cast<unsigned char>(*p)) != *word) return false;
         }
+        return *word == '\0' && (p == line_end || !std::isalnum(static_cast<unsigned char>(*p)));
+    };
+    return !starts_with("BEGIN") && !starts_with("CEND") && !starts_with("ENDDATA");
+}
+
+void push_field(NasCard& card, const char* begin, const char* end) {
+    if (card.field_count < kMaxCardFields) {
+        card.fields[card.field_count++] = {begin, end};
     }
+}
 
-    // Convert vectors to matrices
-    Eigen::MatrixXf vertices(vertices_vec.size(), 3);
-    Eigen::MatrixXi faces(faces_vec.size(), 3);
-    Eigen::MatrixXf normals(normals_vec.size(), 3);
+// Free field: the first comma-separated entry is the card name or
+// continuation marker, followed by up to 8 data fields (4 for large field),
+// padded with blanks so that continuation fields keep their logical position
+void append_free_fields(const char* line, const char* line_end, int field_count, NasCard& card) {
+    const char* p = static_cast<const char*>(std::memchr(line, ',', size_t(line_end - line)));
+    int count = 0;
+    for (; p && p < line_end && count < field_count; ++count) {
+        const char* b = p + 1;
+        const char* e = static_cast<const char*>(std::memchr(b, ',', size_t(line_end - b)));
+        p = e;
+        if (!e) e = line_end;
+        trim_blanks(b, e);
+        push_field(card, b, e);
+    }
+    for (; count < field_count; ++count) {
+        push_field(card, line_end, line_end);
+    }
+}
 
-    for (size_t i = 0; i < vertices_vec.size(); ++i) {
-        vertices.row(i) = vertices_vec[i];
+// Fixed format: columns 9-72 split into `width`-wide fields. Returns false
+// without touching the card when a field holds more than one token, which is
+// how decks that only separate values by whitespace show up.
+bool append_fixed_fields(const char* line, const char* line_end, int width, NasCard& card) {
+    TextField fields[8];
+    const int field_count = 64 / width;
+    const char* data_end = std::min(line_end, line + 72);
+    for (int k = 0; k < field_count; ++k) {
+        const char* b = std::min(line + 8 + k * width, data_end);
+        const char* e = std::min(b + width, data_end);
+        trim_blanks(b, e);
+        for (const char* q = b; q < e; ++q) {
+            if (is_blank(*q)) return false;
+        }
+        fields[k] = {b, e};
     }
-    for (size_t i = 0; i < faces_vec.size(); ++i) {
-        faces.row(i) = faces_vec[i];
+    for (int k = 0; k < field_count; ++k) {
+        push_field(card, fields[k].begin, fields[k].end);
     }
-    for (size_t i = 0; i < normals_vec.size(); ++i) {
-        normals.row(i) = normals_vec[i];
+    return true;
+}
+
+// Whitespace separated: every token after the card name (or continuation
+// marker) is a field
+void append_blank_fields(const char* line, const char* line_end, NasCard& card) {
+    const char* p = line;
+    while (p < line_end && !is_blank(*p)) ++p;
+    while (true) {
+        while (p < line_end && is_blank(*p)) ++p;
+        if (p == line_end) break;
+        const char* b = p;
+        while (p < line_end && !is_blank(*p)) ++p;
+        push_field(card, b, p);
     }
+    card.whitespace_split = true;
+}
 
-    return MeshData{vertices, faces, normals};
+void append_line_fields(const char* line, const char* line_end, bool large_field, NasCard& card) {
+    if (std::memchr(line, ',', size_t(line_end - line))) {
+        append_free_fields(line, line_end, large_field ? 4 : 8, card);
+    } else if (!append_fixed_fields(line, line_end, large_field ? 16 : 8, card)) {
+        append_blank_fields(line, line_end, card);
+    }
 }
 
-MeshData STLReader::read(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Cannot open file: " + file_path);
+// Fields actually present; whitespace-split lines carry no blank fields,
+// fixed-format continuation lines pad with them
+int filled_field_count(const NasCard& card) {
+    int count = 0;
+    for (int k = 0; k < card.field_count; ++k) {
+        count += card.fields[k].begin != card.fields[k].end ? 1 : 0;
     }
+    return count;
+}
+
+bool parse_int_field(const NasCard& card, int index, int& value) {
+    return index < card.field_count &&
+           parse_int(card.fields[index].begin, card.fields[index].end, value);
+}
 
-    std::vector<char> header(80);
-    file.read(header.data(), 80);
+// Blank real fields default to 0.0 as in NASTRAN
+bool parse_real_field(const NasCard& card, int index, float& value) {
+    if (index >= card.field_count || card.fields[index].begin == card.fields[index].end) {
+        value = 0.0f;
+        return true;
+    }
+    return parse_real(card.fields[index].begin, card.fields[index].end, value);
+}
 
-    file.close();
+// GRID ID CP X1 X2 X3
+bool add_grid(const NasCard& card, NasBulkData& out) {
+    // Whitespace splitting drops a blank CP, leaving ID X1 X2 X3
+    const int xi = (card.whitespace_split && filled_field_count(card) == 4) ? 1 : 2;
 
-    if (is_binary(header)) {
-        return read_binary(file_path);
-    } else {
-        return read_ascii(file_path);
+    int id;
+    float x, y, z;
+    if (!parse_int_field(card, 0, id) || !parse_real_field(card, xi, x) ||
+        !parse_real_field(card, xi + 1, y) || !parse_real_field(card, xi + 2, z)) {
+        return false;
+    }
+
+    out.node_ids.push_back(id);
+    out.coords.push_back(x);
+    out.coords.push_back(y);
+    out.coords.push_back(z);
+    return true;
+}
+
+// CTRIA3/CTRIA6/CQUAD4 EID PID G1 ... Gn; only the corner nodes are kept,
+// so CTRIA6 drops its mid-side nodes
+bool add_element(const NasCard& card, int node_count, int corners, NasBulkData& out) {
+    // Whitespace splitting drops a blank PID, leaving EID G1 ... Gn
+    const int gi = (card.whitespace_split && filled_field_count(card) == node_count + 1) ? 1 : 2;
+
+    int g[4];
+    for (int k = 0; k < corners; ++k) {
+        if (!parse_int_field(card, gi + k, g[k])) return false;
     }
+
+    out.elem_nodes.insert(out.elem_nodes.end(), g, g + corners);
+    out.elem_corners.push_back(uint8_t(corners));
+    return true;
 }
 
-MeshData NASReader::read(const std::string& file_path) {
-    size_t vertex_count = 0;
-    size_t face_count = 0;
+// Consumes the card (or skipped line) starting at p and advances p past it
+// and its continuation lines
+void parse_next_card(const char*& p, const char* end, NasCard& card, NasBulkData& out) {
+    const char* line_end = find_line_end(p, end);
+    const char* next = line_end < end ? line_end + 1 : end;
 
-    // --- First Pass: Count vertices and faces ---
-    {
-        std::ifstream counter_file(file_path);
-        if (!counter_file) {
-            throw std::runtime_error("Cannot open file for counting: " + file_path);
-        }
-        std::string line;
-        while (std::getline(counter_file, line)) {
-            if (line.rfind("GRID*", 0) == 0) { // Check prefix efficiently
-                vertex_count++;
-                // Skip the next line for GRID*
-                std::getline(counter_file, line);
-            } else if (line.rfind("CTRIA3", 0) == 0) {
-                face_count++;
+    bool large_field = false;
+    const NasCardType type = card_type(p, strip_carriage_return(p, line_end), large_field);
+    out.line_count += 1;
+    if (type == NasCardType::Unsupported) {
+        // An ignored card counts once, together with its continuation lines
+        if (is_card_name_line(p, strip_carriage_return(p, line_end))) {
+            out.unsupported_count += 1;
+            while (next < end && is_continuation_line(next, end)) {
+                const char* cont_end = find_line_end(next, end);
+                next = cont_end < end ? cont_end + 1 : end;
+                out.line_count += 1;
             }
-            // Add counting for other supported types if necessary
         }
+        p = next;
+        return;
     }
 
+    card.field_count = 0;
+    card.whitespace_split = false;
+    append_line_fields(p, strip_carriage_return(p, line_end), large_field, card);
+    while (next < end && is_continuation_line(next, end)) {
+        const char* cont = next;
+        const char* cont_end = find_line_end(cont, end);
+        next = cont_end < end ? cont_end + 1 : end;
+        append_line_fields(cont, strip_carriage_return(cont, cont_end), *cont == '*', card);
+        out.line_count += 1;
+    }
+
+    bool valid = false;
+    switch (type) {
+        case NasCardType::Grid:   valid = add_grid(card, out); break;
+        case NasCardType::Ctria3: valid = add_element(card, 3, 3, out); break;
+        case NasCardType::Ctria6: valid = add_element(card, 6, 3, out); break;
+        case NasCardType::Cquad4: valid = add_element(card, 4, 4, out); break;
+        default: break;
+    }
+    out.card_count += 1;
+    out.invalid_count += valid ? 0 : 1;
+    p = next;
+}
+
+// Scans the bulk data cards in [p, end) once, without copying lines
+void parse_nas_range(const char* p, const char* end, NasBulkData& out) {
+    NasCard card;
+    while (p < end) {
+        parse_next_card(p, end, card, out);
+    }
+}
+
+// Maps GRID ids to vertex indices: a dense table when the ids are compact,
+// a sorted (id, index) array otherwise. Later definitions of an id win.
+class NodeIndex {
+public:
+    NodeIndex(const std::vector<int>& node_ids, unsigned num_threads) {
+        if (node_ids.empty()) return;
+
+        // Id range, reduced per chunk
+        const size_t chunks = parallel_chunk_count(node_ids.size(), kGrain, num_threads);
+        std::vector<std::pair<int, int>> ranges(chunks, {std::numeric_limits<int>::max(),
+                                                         std::numeric_limits<int>::min()});
+        parallel_for_chunks(0, node_ids.size(), kGrain, [&](size_t c, size_t begin, size_t end) {
+            const auto range = std::minmax_element(node_ids.begin() + begin, node_ids.begin() + end);
+            ranges[c] = {*range.first, *range.second};
+        }, num_threads);
+        int max_id = std::numeric_limits<int>::min();
+        min_id_ = std::numeric_limits<int>::max();
+        for (const auto& range : ranges) {
+            min_id_ = std::min(min_id_, range.first);
+            max_id = std::max(max_id, range.second);
+        }
+        const int64_t span = int64_t(max_id) - int64_t(min_id_) + 1;
+
+        if (span <= int64_t(node_ids.size()) * 2 + 1024) {
+            // Slots are claimed with an atomic max so that the last definition
+            // of a duplicated id wins regardless of thread scheduling
+            dense_size_ = size_t(span);
+            dense_.reset(new std::atomic<int>[dense_size_]);
+            parallel_for(0, dense_size_, kGrain, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    dense_[i].store(-1, std::memory_order_relaxed);
+                }
+            }, num_threads);
+            parallel_for(0, node_ids.size(), kGrain, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    std::atomic<int>& slot = dense_[size_t(node_ids[i] - min_id_)];
+                    int current = slot.load(std::memory_order_relaxed);
+                    while (current < int(i) &&
+                           !slot.compare_exchange_weak(current, int(i), std::memory_order_relaxed)) {
+                    }
+                }
+            }, num_threads);
+        } else {
+            sorted_.reserve(node_ids.size());
+            for (size_t i = 0; i < node_ids.size(); ++i) {
+                sorted_.emplace_back(node_ids[i], int(i));
+            }
+            std::sort(sorted_.begin(), sorted_.end());
+        }
+    }
+
+    // Vertex index of a GRID id, or -1 when the id was never defined
+    int find(int node_id) const {
+        if (dense_) {
+            const int64_t slot = int64_t(node_id) - min_id_;
+            if (slot < 0 || slot >= int64_t(dense_size_)) return -1;
+            return dense_[size_t(slot)].load(std::memory_order_relaxed);
+        }
+        auto it = std::upper_bound(sorted_.begin(), sorted_.end(),
+                                   std::make_pair(node_id, std::numeric_limits<int>::max()));
+        if (it == sorted_.begin() || (it - 1)->first != node_id) return -1;
+        return (it - 1)->second;
+    }
+
+    size_t memory_bytes() const {
+        return dense_size_ * sizeof(std::atomic<int>) + sorted_.capacity() * sizeof(sorted_[0]);
+    }
+
+private:
+    static constexpr size_t kGrain = 1 << 16;
+
+    int min_id_ = 0;
+    size_t dense_size_ = 0;
+    std::unique_ptr<std::atomic<int>[]> dense_;
+    std::vector<std::pair<int, int>> sorted_;
+};
+
+// Splits quad (a, b, c, d) along its shorter diagonal, keeping the winding
+void split_quad(const RowMatrixXf& vertices, const int* q, int* tri1, int* tri2) {
+    const float ac = (vertices.row(q[2]) - vertices.row(q[0])).squaredNorm();
+    const float bd = (vertices.row(q[3]) - vertices.row(q[1])).squaredNorm();
+    if (ac <= bd) {
+        tri1[0] = q[0]; tri1[1] = q[1]; tri1[2] = q[2];
+        tri2[0] = q[0]; tri2[1] = q[2]; tri2[2] = q[3];
+    } else {
+        tri1[0] = q[0]; tri1[1] = q[1]; tri1[2] = q[3];
+        tri2[0] = q[1]; tri2[1] = q[2]; tri2[2] = q[3];
+    }
+}
+
+// Assembles the mesh from per-chunk parse results (in file order)
+MeshData build_nas_mesh(std::vector<NasBulkData>& chunks, const ReadOptions& options,
+                        LoadStats& stats) {
+    PhaseTimer timer(stats);
+    const unsigned num_threads = options.num_threads;
+    const size_t chunk_count = chunks.size();
+    std::vector<size_t> vertex_offsets(chunk_count + 1, 0);
+    size_t element_count = 0;
+    size_t chunk_bytes = 0;
+    for (size_t c = 0; c < chunk_count; ++c) {
+        vertex_offsets[c + 1] = vertex_offsets[c] + chunks[c].node_ids.size();
+        element_count += chunks[c].elem_corners.size();
+        chunk_bytes += chunks[c].scratch_bytes();
+    }
+    const size_t vertex_count = vertex_offsets[chunk_count];
+    stats.peak_scratch_bytes = chunk_bytes;
     if (vertex_count == 0) {
-         return MeshData{Eigen::MatrixXf(), Eigen::MatrixXi(), Eigen::MatrixXf()};
-    }
-
-    // --- Pre-allocate Eigen Matrices ---
-    Eigen::MatrixXf vertices(vertex_count, 3);
-    Eigen::MatrixXi faces(face_count, 3);
-    std::unordered_map<int, int> node_map;
-    node_map.reserve(vertex_count);
-    size_t current_vertex_index = 0;
-    size_t current_face_index = 0;
-
-
-    // --- Second Pass: Read data and fill matrices ---
-    std::ifstream file(file_path);
-    if (!file) {
-        throw std::runtime_error("Cannot open file for reading: " + file_path);
-    }
-
-    std::string line;
-    int line_num = 0;
-    while (std::getline(file, line)) {
-        line_num++;
-        std::istringstream iss(line);
-        std::string token;
-        iss >> token;
-
-        if (token == "GRID*") {
-            int node_id;
-            float x, y;
-            iss >> node_id >> token >> x >> y;
-
-            if (!std::getline(file, line)) break;
-            line_num++;
-            iss.clear();
-            iss.str(line);
-            float z;
-            iss >> token >> z;
-
-            if (current_vertex_index < vertex_count) {
-                node_map[node_id] = current_vertex_index;
-                vertices.row(current_vertex_index) << x, y, z;
-                current_vertex_index++;
+        stats.unresolved_elements = element_count;
+        return MeshData{RowMatrixXf(), RowMatrixXi(), RowMatrixXf(), RowMatrixXi(), {}};
+    }
+
+    // Every chunk copies its GRIDs into its own slice of the output
+    RowMatrixXf vertices(vertex_count, 3);
+    std::vector<int> node_ids(vertex_count);
+    parallel_for(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            const NasBulkData& chunk = chunks[c];
+            const size_t offset = vertex_offsets[c];
+            std::copy(chunk.node_ids.begin(), chunk.node_ids.end(), node_ids.begin() + offset);
+            for (size_t i = 0; i < chunk.node_ids.size(); ++i) {
+                vertices(offset + i, 0) = chunk.coords[i * 3];
+                vertices(offset + i, 1) = chunk.coords[i * 3 + 1];
+                vertices(offset + i, 2) = chunk.coords[i * 3 + 2];
             }
         }
-        else if (token == "CTRIA3") {
-            int elem_id;
-            int v1, v2, v3;
-            iss >> elem_id >> token >> v1 >> v2 >> v3;
-
-            if (current_face_index < face_count) {
-                try {
-                     faces.row(current_face_index) << node_map.at(v1), node_map.at(v2), node_map.at(v3);
-                     current_face_index++;
-                } catch (const std::out_of_range& oor) {
-                     // Node ID referenced before it was defined - skip face
-                     // Optionally add logging here
+    }, num_threads);
+    timer.lap("gather_vertices");
+
+    // Elements may reference GRIDs defined later in the deck (or in another
+    // chunk), so node ids are resolved only once every card has been read.
+    // Each chunk resolves its ids in place and marks elements with undefined
+    // nodes (first corner set to -1), which are skipped.
+    const NodeIndex node_index(node_ids, num_threads);
+    stats.peak_scratch_bytes = chunk_bytes + node_ids.size() * sizeof(int) + node_index.memory_bytes();
+    std::vector<size_t> face_offsets(chunk_count + 1, 0);
+    std::vector<size_t> quad_offsets(chunk_count + 1, 0);
+    std::vector<size_t> unresolved(chunk_count, 0);
+    parallel_for(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            std::vector<int>& elem_nodes = chunks[c].elem_nodes;
+            const std::vector<uint8_t>& elem_corners = chunks[c].elem_corners;
+            size_t face_count = 0;
+            size_t quad_count = 0;
+            size_t n = 0;
+            for (const uint8_t corners : elem_corners) {
+                bool resolved = true;
+                for (int k = 0; k < corners; ++k) {
+                    elem_nodes[n + k] = node_index.find(elem_nodes[n + k]);
+                    resolved = resolved && elem_nodes[n + k] >= 0;
                 }
+                if (!resolved) {
+                    elem_nodes[n] = -1;
+                    unresolved[c] += 1;
+                }
+                n += corners;
+                if (!resolved) {
+                    continue;
+                } else if (corners == 3) {
+                    face_count += 1;
+                } else if (options.split_quads) {
+                    face_count += 2;
+                } else {
+                    quad_count += 1;
+                }
+            }
+            face_offsets[c + 1] = face_count;
+            quad_offsets[c + 1] = quad_count;
+        }
+    }, num_threads);
+    for (size_t c = 0; c < chunk_count; ++c) {
+        face_offsets[c + 1] += face_offsets[c];
+        quad_offsets[c + 1] += quad_offsets[c];
+        stats.unresolved_elements += unresolved[c];
+    }
+    timer.lap("resolve_nodes");
+
+    RowMatrixXi faces(face_offsets[chunk_count], 3);
+    RowMatrixXi quads(quad_offsets[chunk_count], 4);
+    parallel_for(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            const std::vector<int>& elem_nodes = chunks[c].elem_nodes;
+            size_t face_row = face_offsets[c];
+            size_t quad_row = quad_offsets[c];
+            size_t n = 0;
+            for (const uint8_t corners : chunks[c].elem_corners) {
+                const int* g = &elem_nodes[n];
+                n += corners;
+                if (g[0] < 0) {
+                    continue;
+                } else if (corners == 3) {
+                    faces.row(face_row++) << g[0], g[1], g[2];
+                } else if (options.split_quads) {
+                    int tri1[3], tri2[3];
+                    split_quad(vertices, g, tri1, tri2);
+                    faces.row(face_row++) << tri1[0], tri1[1], tri1[2];
+                    faces.row(face_row++) << tri2[0], tri2[1], tri2[2];
+                } else {
+                    quads.row(quad_row++) << g[0], g[1], g[2], g[3];
+                }
+            }
+        }
+    }, num_threads);
+
+    timer.lap("assemble");
+    return MeshData{std::move(vertices), std::move(faces), RowMatrixXf(), std::move(quads), {}};
+}
+
+// Scans a deck card by card, handing out vertices and elements in blocks.
+// Only a GRID id -> vertex index table is kept across blocks, so elements
+// must follow the GRIDs they reference (as decks normally do); elements
+// referencing unseen GRIDs are skipped. Quads are split along their first
+// diagonal since earlier vertex blocks are no longer available.
+class NasStream : public MeshStream {
+public:
+    NasStream(MappedFile file, size_t block_size, bool split_quads)
+        : file_(std::move(file)), block_size_(std::max<size_t>(block_size, 1)),
+          split_quads_(split_quads), cursor_(file_.data()) {}
+
+    bool next(MeshBlock& block) override {
+        while (pending_.empty() && cursor_ < file_.data() + file_.size()) {
+            fill_blocks();
+        }
+        if (pending_.empty()) {
+            return false;
+        }
+        block = std::move(pending_.front());
+        pending_.pop_front();
+        return true;
+    }
+
+private:
+    void fill_blocks() {
+        const char* end = file_.data() + file_.size();
+        scratch_.node_ids.clear();
+        scratch_.coords.clear();
+        scratch_.elem_nodes.clear();
+        scratch_.elem_corners.clear();
+        while (cursor_ < end && scratch_.node_ids.size() < block_size_ &&
+               scratch_.elem_corners.size() < block_size_) {
+            parse_next_card(cursor_, end, card_, scratch_);
+        }
+        const size_t consumed = size_t(cursor_ - file_.data());
+        file_.release(released_, consumed - released_);
+        released_ = consumed;
+
+        if (!scratch_.node_ids.empty()) {
+            MeshBlock block;
+            block.kind = MeshBlock::Kind::Vertices;
+            block.first = vertex_count_;
+            block.vertices.resize(scratch_.node_ids.size(), 3);
+            for (size_t i = 0; i < scratch_.node_ids.size(); ++i) {
+                block.vertices.row(i) << scratch_.coords[i * 3], scratch_.coords[i * 3 + 1],
+                    scratch_.coords[i * 3 + 2];
+                assign(scratch_.node_ids[i], int(vertex_count_ + i));
+            }
+            vertex_count_ += scratch_.node_ids.size();
+            pending_.push_back(std::move(block));
+        }
+
+        std::vector<int> tris;
+        std::vector<int> quads;
+        size_t n = 0;
+        for (const uint8_t corners : scratch_.elem_corners) {
+            int g[4];
+            bool resolved = true;
+            for (int k = 0; k < corners; ++k) {
+                g[k] = lookup(scratch_.elem_nodes[n + k]);
+                resolved = resolved && g[k] >= 0;
+            }
+            n += corners;
+            if (!resolved) continue;
+            if (corners == 3) {
+                tris.insert(tris.end(), g, g + 3);
+            } else if (split_quads_) {
+                tris.insert(tris.end(), {g[0], g[1], g[2], g[0], g[2], g[3]});
+            } else {
+                quads.insert(quads.end(), g, g + 4);
             }
         }
+        if (!tris.empty()) {
+            MeshBlock block;
+            block.kind = MeshBlock::Kind::Faces;
+            block.first = face_count_;
+            block.faces = Eigen::Map<const Eigen::Matrix<int, Eigen::Dynamic, 3, Eigen::RowMajor>>(
+                tris.data(), Eigen::Index(tris.size() / 3), 3);
+            face_count_ += tris.size() / 3;
+            pending_.push_back(std::move(block));
+        }
+        if (!quads.empty()) {
+            MeshBlock block;
+            block.kind = MeshBlock::Kind::Quads;
+            block.first = quad_count_;
+            block.quads = Eigen::Map<const Eigen::Matrix<int, Eigen::Dynamic, 4, Eigen::RowMajor>>(
+                quads.data(), Eigen::Index(quads.size() / 4), 4);
+            quad_count_ += quads.size() / 4;
+            pending_.push_back(std::move(block));
+        }
     }
 
-     if (current_face_index < face_count) {
-         faces.conservativeResize(current_face_index, 3);
-     }
+    // Ids are kept in a dense table while they stay reasonably compact and
+    // in a hash map beyond that
+    void assign(int node_id, int index) {
+        if (node_id >= 0 && size_t(node_id) < dense_limit()) {
+            if (size_t(node_id) >= dense_ids_.size()) {
+                dense_ids_.resize(std::max(size_t(node_id) + 1, dense_ids_.size() * 2), -1);
+            }
+            dense_ids_[size_t(node_id)] = index;
+        } else {
+            sparse_ids_[node_id] = index;
+        }
+    }
 
+    int lookup(int node_id) const {
+        if (node_id >= 0 && size_t(node_id) < dense_ids_.size() && dense_ids_[size_t(node_id)] >= 0) {
+            return dense_ids_[size_t(node_id)];
+        }
+        const auto it = sparse_ids_.find(node_id);
+        return it == sparse_ids_.end() ? -1 : it->second;
+    }
 
-    return MeshData{vertices, faces, Eigen::MatrixXf()};
+    size_t dense_limit() const {
+        return (vertex_count_ + block_size_) * 4 + (1u << 20);
+    }
+
+    MappedFile file_;
+    size_t block_size_;
+    bool split_quads_;
+    const char* cursor_;
+    size_t released_ = 0;
+    NasCard card_;
+    NasBulkData scratch_;
+    std::vector<int> dense_ids_;
+    std::unordered_map<int, int> sparse_ids_;
+    size_t vertex_count_ = 0;
+    size_t face_count_ = 0;
+    size_t quad_count_ = 0;
+    std::deque<MeshBlock> pending_;
+};
+
+} // namespace
+
+MeshData NASReader::read(const std::string& file_path) {
+    stats_ = LoadStats();
+    return read_with_cache(file_path, options_, [&]() { return parse(file_path); }, &stats_);
 }
 
-std::unique_ptr<MeshReader> create_mesh_reader(const std::string& file_path) {
+std::unique_ptr<MeshStream> NASReader::open_stream(const std::string& file_path,
+                                                   size_t block_size) {
+    return std::make_unique<NasStream>(MappedFile(file_path), block_size, options_.split_quads);
+}
+
+MeshData NASReader::parse(const std::string& file_path) {
+    PhaseTimer timer(stats_);
+    MappedFile file(file_path);
+    stats_.bytes_read = file.size();
+    timer.lap("map");
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    // Split the deck into byte ranges of roughly equal size, moving every cut
+    // to the next card start, and parse the ranges independently
+    const size_t chunk_count = parallel_chunk_count(file.size(), 1 << 20, options_.num_threads);
+    std::vector<const char*> cuts(chunk_count + 1);
+    cuts[0] = begin;
+    cuts[chunk_count] = end;
+    for (size_t c = 1; c < chunk_count; ++c) {
+        const char* guess = begin + file.size() / chunk_count * c;
+        cuts[c] = std::max(cuts[c - 1], next_card_start(guess, begin, end));
+    }
+
+    std::vector<NasBulkData> chunks(chunk_count);
+    parallel_for(0, chunk_count, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            NasBulkData& data = chunks[c];
+            // Rough guess from typical card sizes; the vectors grow geometrically past it
+            const size_t bytes = size_t(cuts[c + 1] - cuts[c]);
+            data.node_ids.reserve(bytes / 160);
+            data.coords.reserve(bytes / 160 * 3);
+            data.elem_nodes.reserve(bytes / 80 * 3);
+            data.elem_corners.reserve(bytes / 80);
+            parse_nas_range(cuts[c], cuts[c + 1], data);
+        }
+    }, unsigned(chunk_count));
+    for (const NasBulkData& data : chunks) {
+        stats_.lines_parsed += data.line_count;
+        stats_.records_parsed += data.card_count;
+        stats_.unsupported_records += data.unsupported_count;
+        stats_.invalid_records += data.invalid_count;
+    }
+    timer.lap("tokenize");
+
+    return build_nas_mesh(chunks, options_, stats_);
+}
+
+std::unique_ptr<MeshReader> create_mesh_reader(const std::string& file_path,
+                                               const ReadOptions& options) {
     std::string ext = file_path.substr(file_path.find_last_of(".") + 1);
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
 
     if (ext == "nas") {
-        return std::make_unique<NASReader>();
+        return std::make_unique<NASReader>(options);
     }
     else if (ext == "stl") {
-        return std::make_unique<STLReader>();
+        return std::make_unique<STLReader>(options);
+    }
+    else if (ext == "cmz") {
+        return std::make_unique<CMZReader>(options);
     }
     else {
         throw std::runtime_error("Unsupported file format: " + ext);
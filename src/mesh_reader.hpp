@@ -1,43 +1,159 @@
 #ifndef MESH_READER_HPP
 #define MESH_READER_HPP
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <Eigen/Dense>
 
 namespace cfd {
 
+class MappedFile;
+
+// Mesh arrays are stored row-major so each row (a vertex or face) is
+// contiguous and the buffers match C-ordered NumPy arrays one to one
+using RowMatrixXf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using RowMatrixXi = Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Faces [first_face, first_face + face_count) belong to one ASCII STL solid
+struct SolidRange {
+    std::string name;
+    size_t first_face = 0;
+    size_t face_count = 0;
+};
+
 struct MeshData {
-    Eigen::MatrixXf vertices;  // Nx3 matrix for vertices
-    Eigen::MatrixXi faces;     // Mx3 matrix for faces
-    Eigen::MatrixXf normals;   // Mx3 matrix for face normals
+    RowMatrixXf vertices;  // Nx3 matrix for vertices
+    RowMatrixXi faces;     // Mx3 matrix for faces
+    RowMatrixXf normals;   // Mx3 matrix for face normals
+    RowMatrixXi quads;     // Kx4 matrix for quad faces kept unsplit (see ReadOptions::split_quads)
+    std::vector<SolidRange> solids;  // Face ranges of the solids in an ASCII STL, in file order
+};
+
+// Options controlling how mesh files are imported
+struct ReadOptions {
+    unsigned num_threads = 0;     // Worker threads for parsing/decoding (0 = all cores)
+    bool weld_vertices = false;   // Merge coincident STL vertices into an indexed mesh
+    float weld_tolerance = 0.0f;  // Max distance between merged vertices (0 = exact match)
+    bool split_quads = true;      // Split NAS quads into two triangles along the shorter
+                                  // diagonal; false keeps them in MeshData::quads
+    bool use_cache = true;        // Load "<file>.cfdcache" when it is fresh, else write it
+                                  // after parsing (see mesh_cache.hpp)
+};
+
+// What a MeshReader::read call did and where its time went, for profiling
+// and ingest monitoring (see MeshReader::last_stats)
+struct LoadStats {
+    uint64_t bytes_read = 0;           // Size of the file that was read (the cache when from_cache)
+    uint64_t lines_parsed = 0;         // Text lines scanned (NAS)
+    uint64_t records_parsed = 0;       // NAS cards, STL facets or CMZ blocks decoded
+    uint64_t unsupported_records = 0;  // NAS cards of types the reader ignores (e.g. CHEXA)
+    uint64_t invalid_records = 0;      // GRID/element cards dropped for malformed fields
+    uint64_t unresolved_elements = 0;  // Elements dropped for referencing undefined GRIDs
+    uint64_t peak_scratch_bytes = 0;   // Temporary buffers held at once besides the result
+    bool from_cache = false;           // Loaded from "<file>.cfdcache"
+    std::vector<std::pair<std::string, double>> phase_seconds;  // Wall time per phase, in order
+};
+
+// One block of a mesh delivered by MeshStream: vertex blocks fill
+// `vertices`, face blocks fill `faces` (plus `normals` for STL), quad blocks
+// fill `quads` (NAS quads kept unsplit). `first` is the index of the block's
+// first row within the whole mesh's vertices, faces or quads.
+struct MeshBlock {
+    enum class Kind { Vertices, Faces, Quads };
+
+    Kind kind = Kind::Vertices;
+    size_t first = 0;
+    RowMatrixXf vertices;
+    RowMatrixXi faces;
+    RowMatrixXf normals;
+    RowMatrixXi quads;
+};
+
+// Pull-based reader delivering a mesh as a sequence of bounded blocks, so a
+// single sweep over a file larger than memory only holds one block at a time
+class MeshStream {
+public:
+    virtual ~MeshStream() = default;
+
+    // Fills `block` with the next block; returns false once the file is exhausted
+    virtual bool next(MeshBlock& block) = 0;
 };
 
 class MeshReader {
 public:
     virtual ~MeshReader() = default;
     virtual MeshData read(const std::string& file_path) = 0;
+
+    // Opens the file for block-wise reading with at most block_size vertices
+    // or faces per block. The default implementation reads the whole mesh and
+    // slices it; readers override it to stream from the file.
+    virtual std::unique_ptr<MeshStream> open_stream(const std::string& file_path,
+                                                    size_t block_size);
+
+    // Statistics of the most recent read() on this reader
+    const LoadStats& last_stats() const { return stats_; }
+
+protected:
+    LoadStats stats_;
 };
 
 class STLReader : public MeshReader {
 public:
+    STLReader() = default;
+    explicit STLReader(const ReadOptions& options) : options_(options) {}
+
     MeshData read(const std::string& file_path) override;
+    std::unique_ptr<MeshStream> open_stream(const std::string& file_path,
+                                            size_t block_size) override;
 
 private:
-    bool is_binary(const std::vector<char>& header);
-    MeshData read_binary(const std::string& file_path);
-    MeshData read_ascii(const std::string& file_path);
+    bool is_binary(const MappedFile& file);
+    MeshData read_binary(const MappedFile& file);
+    MeshData read_ascii(const MappedFile& file);
+
+    ReadOptions options_;
 };
 
 class NASReader : public MeshReader {
 public:
+    NASReader() = default;
+    explicit NASReader(const ReadOptions& options) : options_(options) {}
+
+    MeshData read(const std::string& file_path) override;
+    std::unique_ptr<MeshStream> open_stream(const std::string& file_path,
+                                            size_t block_size) override;
+
+private:
+    MeshData parse(const std::string& file_path);
+
+    ReadOptions options_;
+};
+
+// Block-compressed binary container (".cmz", written by CMZWriter). Blocks
+// are independent and decoded in parallel straight into MeshData.
+class CMZReader : public MeshReader {
+public:
+    CMZReader() = default;
+    explicit CMZReader(const ReadOptions& options) : options_(options) {}
+
     MeshData read(const std::string& file_path) override;
+
+private:
+    ReadOptions options_;
 };
 
-std::unique_ptr<MeshReader> create_mesh_reader(const std::string& file_path);
+std::unique_ptr<MeshReader> create_mesh_reader(const std::string& file_path,
+                                               const ReadOptions& options = ReadOptions());
 MeshData read_nas_file(const std::string& file_path);
 
+// Merges vertices that lie within tolerance of each other (exact matches when
+// tolerance is 0) and remaps faces onto the merged vertices. Vertices keep the
+// order of their first appearance; unreferenced vertices are dropped.
+void weld_vertices(MeshData& mesh, float tolerance = 0.0f);
+
 } // namespace cfd
 
 #endif // MESH_READER_HPP 
\ No newline at end of file
@@ -2,30 +2,378 @@
 #include <pybind11/eigen.h>
 #include <pybind11/stl.h>
 #include "mesh_reader.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_writer.hpp"
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
+#include "face_quality.hpp"
 
 namespace py = pybind11;
 
+namespace {
+
+using RowMatrixXd = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+static_assert(sizeof(cfd::AABB) == 6 * sizeof(double), "AABB must be six packed doubles");
+static_assert(sizeof(cfd::Vector3d) == 3 * sizeof(double), "Vector3d must be three packed doubles");
+
+// Read-only NumPy view of a buffer owned by the Mesh held in `self`
+template <typename Matrix, typename T>
+py::object mesh_view(const py::object& self, const T* data, size_t rows, size_t cols) {
+    Eigen::Map<const Matrix> map(data, Eigen::Index(rows), Eigen::Index(cols));
+    return py::cast(map, py::return_value_policy::reference_internal, self);
+}
+
+py::object vector_view(const py::object& self, const std::vector<int32_t>& values) {
+    Eigen::Map<const Eigen::VectorXi> map(values.data(), Eigen::Index(values.size()));
+    return py::cast(map, py::return_value_policy::reference_internal, self);
+}
+
+py::object incidence_views(const py::object& self, const cfd::Incidence& incidence) {
+    return py::make_tuple(vector_view(self, incidence.offsets), vector_view(self, incidence.indices));
+}
+
+// Cached Mesh structures, built with the GIL released on first use
+const cfd::EdgeTopology& cached_edges(const cfd::Mesh& mesh) {
+    py::gil_scoped_release release;
+    return mesh.edges();
+}
+
+const cfd::Incidence& cached_vertex_faces(const cfd::Mesh& mesh) {
+    py::gil_scoped_release release;
+    return mesh.vertex_faces();
+}
+
+const std::vector<cfd::AABB>& cached_face_boxes(const cfd::Mesh& mesh) {
+    py::gil_scoped_release release;
+    return mesh.face_boxes();
+}
+
+const std::vector<cfd::Vector3d>& cached_face_normals(const cfd::Mesh& mesh) {
+    py::gil_scoped_release release;
+    return mesh.face_normals();
+}
+
+} // namespace
+
 PYBIND11_MODULE(mesh_reader_cpp, m) {
     m.doc() = "C++ implementation of mesh reader for improved performance";
 
+    py::class_<cfd::SolidRange>(m, "SolidRange")
+        .def(py::init<>())
+        .def_readwrite("name", &cfd::SolidRange::name)
+        .def_readwrite("first_face", &cfd::SolidRange::first_face)
+        .def_readwrite("face_count", &cfd::SolidRange::face_count)
+        .def("__repr__", [](const cfd::SolidRange& solid) {
+            return "<SolidRange '" + solid.name + "' faces " + std::to_string(solid.first_face) +
+                   "+" + std::to_string(solid.face_count) + ">";
+        });
+
+    // Array attributes are read-only NumPy views of the row-major C++
+    // buffers; each view keeps its MeshData alive. The buffers are never
+    // replaced once the MeshData is visible to Python, so a view cannot
+    // outlive its storage: build a new MeshData from arrays instead (the
+    // constructor copies them), and weld_vertices returns a new MeshData.
     py::class_<cfd::MeshData>(m, "MeshData")
         .def(py::init<>())
-        .def_readwrite("vertices", &cfd::MeshData::vertices)
-        .def_readwrite("faces", &cfd::MeshData::faces)
-        .def_readwrite("normals", &cfd::MeshData::normals);
+        .def(py::init([](const cfd::RowMatrixXf& vertices, const cfd::RowMatrixXi& faces,
+                         const py::object& normals, const py::object& quads,
+                         const std::vector<cfd::SolidRange>& solids) {
+                 if (vertices.cols() != 3 || faces.cols() != 3) {
+                     throw std::runtime_error("Vertices and faces must have shape (n, 3)");
+                 }
+                 cfd::MeshData mesh;
+                 mesh.vertices = vertices;
+                 mesh.faces = faces;
+                 mesh.normals = normals.is_none() ? cfd::RowMatrixXf(0, 3) : normals.cast<cfd::RowMatrixXf>();
+                 mesh.quads = quads.is_none() ? cfd::RowMatrixXi(0, 4) : quads.cast<cfd::RowMatrixXi>();
+                 mesh.solids = solids;
+                 return mesh;
+             }),
+             py::arg("vertices"), py::arg("faces"), py::arg("normals") = py::none(),
+             py::arg("quads") = py::none(), py::arg("solids") = std::vector<cfd::SolidRange>())
+        .def_property_readonly("vertices",
+                               [](const cfd::MeshData& mesh) -> const cfd::RowMatrixXf& { return mesh.vertices; },
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("faces",
+                               [](const cfd::MeshData& mesh) -> const cfd::RowMatrixXi& { return mesh.faces; },
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("normals",
+                               [](const cfd::MeshData& mesh) -> const cfd::RowMatrixXf& { return mesh.normals; },
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("quads",
+                               [](const cfd::MeshData& mesh) -> const cfd::RowMatrixXi& { return mesh.quads; },
+                               py::return_value_policy::reference_internal)
+        .def_readwrite("solids", &cfd::MeshData::solids);
+
+    // Immutable mesh handle shared by the detector modules. Derived topology
+    // is computed on first use and cached; array results are read-only views
+    // that keep the Mesh alive.
+    py::class_<cfd::Mesh>(m, "Mesh")
+        .def(py::init([](const py::array& vertices, const py::array& faces) {
+                 return cfd::mesh_from_arrays(vertices, faces);
+             }),
+             py::arg("vertices"), py::arg("faces"))
+        .def(py::init([](const cfd::MeshData& data) {
+                 return cfd::Mesh(data.vertices.data(), size_t(data.vertices.rows()),
+                                  data.faces.data(), size_t(data.faces.rows()));
+             }),
+             py::arg("mesh_data"))
+        .def_property_readonly("num_vertices", &cfd::Mesh::num_vertices)
+        .def_property_readonly("num_faces", &cfd::Mesh::num_faces)
+        .def_property_readonly("vertices", [](const cfd::Mesh& mesh) {
+            RowMatrixXd vertices(Eigen::Index(mesh.num_vertices()), 3);
+            for (size_t i = 0; i < mesh.num_vertices(); ++i) {
+                vertices.row(Eigen::Index(i)) << mesh.x()[i], mesh.y()[i], mesh.z()[i];
+            }
+            return vertices;
+        })
+        .def_property_readonly("faces", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            return mesh_view<cfd::RowMatrixXi>(self, mesh.faces().data(), mesh.num_faces(), 3);
+        })
+        .def_property_readonly("cached", &cfd::Mesh::cached)
+        .def("edges", [](const cfd::Mesh& mesh) {
+            const cfd::EdgeTopology& topology = cached_edges(mesh);
+            cfd::RowMatrixXi edges(Eigen::Index(topology.num_edges()), 2);
+            for (size_t e = 0; e < topology.num_edges(); ++e) {
+                edges.row(Eigen::Index(e)) << cfd::edge_key_first(topology.keys[e]),
+                    cfd::edge_key_second(topology.keys[e]);
+            }
+            return edges;
+        }, "Unique edges as an (E, 2) array of (smaller, larger) vertex indices, sorted")
+        .def("edge_faces", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            const cfd::EdgeTopology& topology = cached_edges(mesh);
+            return incidence_views(self, topology.edge_faces);
+        }, "(offsets, faces) CSR arrays of the faces using each edge")
+        .def("face_edges", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            const cfd::EdgeTopology& topology = cached_edges(mesh);
+            return mesh_view<cfd::RowMatrixXi>(self, topology.face_edges.data(), mesh.num_faces(), 3);
+        }, "(F, 3) edge ids of (v0,v1), (v1,v2), (v2,v0) for each face")
+        .def("free_edges", [](const cfd::Mesh& mesh) {
+            const std::vector<int32_t> ids = cfd::free_edges(cached_edges(mesh));
+            return Eigen::VectorXi(Eigen::Map<const Eigen::VectorXi>(ids.data(), Eigen::Index(ids.size())));
+        }, "Ids of the edges used by exactly one face")
+        .def("non_manifold_edges", [](const cfd::Mesh& mesh) {
+            const std::vector<int32_t> ids = cfd::non_manifold_edges(cached_edges(mesh));
+            return Eigen::VectorXi(Eigen::Map<const Eigen::VectorXi>(ids.data(), Eigen::Index(ids.size())));
+        }, "Ids of the edges shared by more than two faces")
+        .def("boundary_loops", [](const cfd::Mesh& mesh) {
+            cfd::BoundaryLoops loops;
+            {
+                py::gil_scoped_release release;
+                loops = cfd::boundary_loops(mesh);
+            }
+            return cfd::boundary_loops_to_dict(loops);
+        }, "Free edges chained into loops, largest perimeter first (dict of arrays)")
+        .def("vertex_faces", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            return incidence_views(self, cached_vertex_faces(mesh));
+        }, "(offsets, faces) CSR arrays of the faces around each vertex")
+        .def("face_boxes", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            const std::vector<cfd::AABB>& boxes = cached_face_boxes(mesh);
+            return mesh_view<RowMatrixXd>(self, reinterpret_cast<const double*>(boxes.data()),
+                                          boxes.size(), 6);
+        }, "(F, 6) face bounding boxes as min xyz, max xyz")
+        .def("face_normals", [](const py::object& self) {
+            const cfd::Mesh& mesh = self.cast<const cfd::Mesh&>();
+            const std::vector<cfd::Vector3d>& normals = cached_face_normals(mesh);
+            return mesh_view<RowMatrixXd>(self, reinterpret_cast<const double*>(normals.data()),
+                                          normals.size(), 3);
+        }, "(F, 3) unit face normals, zero for degenerate faces")
+        .def("face_quality", [](const cfd::Mesh& mesh) {
+            Eigen::VectorXf quality(Eigen::Index(mesh.num_faces()));
+            {
+                py::gil_scoped_release release;
+                cfd::face_quality(mesh, quality.data());
+            }
+            return quality;
+        }, "Quality 2r/R of every face (float32), 1 for equilateral and 0 for degenerate faces")
+        .def("__repr__", [](const cfd::Mesh& mesh) {
+            return "<Mesh " + std::to_string(mesh.num_vertices()) + " vertices, " +
+                   std::to_string(mesh.num_faces()) + " faces>";
+        });
+
+    py::class_<cfd::ReadOptions>(m, "ReadOptions")
+        .def(py::init<>())
+        .def_readwrite("num_threads", &cfd::ReadOptions::num_threads)
+        .def_readwrite("weld_vertices", &cfd::ReadOptions::weld_vertices)
+        .def_readwrite("weld_tolerance", &cfd::ReadOptions::weld_tolerance)
+        .def_readwrite("split_quads", &cfd::ReadOptions::split_quads)
+        .def_readwrite("use_cache", &cfd::ReadOptions::use_cache);
+
+    py::class_<cfd::LoadStats>(m, "LoadStats")
+        .def(py::init<>())
+        .def_readonly("bytes_read", &cfd::LoadStats::bytes_read)
+        .def_readonly("lines_parsed", &cfd::LoadStats::lines_parsed)
+        .def_readonly("records_parsed", &cfd::LoadStats::records_parsed)
+        .def_readonly("unsupported_records", &cfd::LoadStats::unsupported_records)
+        .def_readonly("invalid_records", &cfd::LoadStats::invalid_records)
+        .def_readonly("unresolved_elements", &cfd::LoadStats::unresolved_elements)
+        .def_readonly("peak_scratch_bytes", &cfd::LoadStats::peak_scratch_bytes)
+        .def_readonly("from_cache", &cfd::LoadStats::from_cache)
+        .def_readonly("phase_seconds", &cfd::LoadStats::phase_seconds)
+        .def("to_dict", [](const cfd::LoadStats& stats) {
+            py::dict phases;
+            for (const auto& phase : stats.phase_seconds) {
+                phases[py::str(phase.first)] = phase.second;
+            }
+            py::dict result;
+            result["bytes_read"] = stats.bytes_read;
+            result["lines_parsed"] = stats.lines_parsed;
+            result["records_parsed"] = stats.records_parsed;
+            result["unsupported_records"] = stats.unsupported_records;
+            result["invalid_records"] = stats.invalid_records;
+            result["unresolved_elements"] = stats.unresolved_elements;
+            result["peak_scratch_bytes"] = stats.peak_scratch_bytes;
+            result["from_cache"] = stats.from_cache;
+            result["phase_seconds"] = phases;
+            return result;
+        });
+
+    py::class_<cfd::MeshBlock> block(m, "MeshBlock");
+    py::enum_<cfd::MeshBlock::Kind>(block, "Kind")
+        .value("Vertices", cfd::MeshBlock::Kind::Vertices)
+        .value("Faces", cfd::MeshBlock::Kind::Faces)
+        .value("Quads", cfd::MeshBlock::Kind::Quads);
+    block
+        .def_readonly("kind", &cfd::MeshBlock::kind)
+        .def_readonly("first", &cfd::MeshBlock::first)
+        .def_readonly("vertices", &cfd::MeshBlock::vertices)
+        .def_readonly("faces", &cfd::MeshBlock::faces)
+        .def_readonly("normals", &cfd::MeshBlock::normals)
+        .def_readonly("quads", &cfd::MeshBlock::quads);
+
+    // Iterating a stream yields MeshBlocks until the file is exhausted
+    py::class_<cfd::MeshStream>(m, "MeshStream")
+        .def("__iter__", [](cfd::MeshStream& stream) -> cfd::MeshStream& { return stream; },
+             py::return_value_policy::reference_internal)
+        .def("__next__", [](cfd::MeshStream& stream) {
+            cfd::MeshBlock block;
+            bool has_block;
+            {
+                py::gil_scoped_release release;
+                has_block = stream.next(block);
+            }
+            if (!has_block) {
+                throw py::stop_iteration();
+            }
+            return block;
+        });
 
     py::class_<cfd::MeshReader, std::unique_ptr<cfd::MeshReader>>(m, "MeshReader")
-        .def("read", &cfd::MeshReader::read);
+        .def("read", &cfd::MeshReader::read)
+        .def_property_readonly("last_stats", &cfd::MeshReader::last_stats)
+        .def("open_stream", &cfd::MeshReader::open_stream,
+             py::arg("file_path"), py::arg("block_size") = size_t(1) << 20);
 
     py::class_<cfd::STLReader, cfd::MeshReader>(m, "STLReader")
-        .def(py::init<>());
+        .def(py::init<>())
+        .def(py::init<const cfd::ReadOptions&>(), py::arg("options"));
 
     py::class_<cfd::NASReader, cfd::MeshReader>(m, "NASReader")
-        .def(py::init<>());
+        .def(py::init<>())
+        .def(py::init<const cfd::ReadOptions&>(), py::arg("options"));
+
+    py::class_<cfd::CMZReader, cfd::MeshReader>(m, "CMZReader")
+        .def(py::init<>())
+        .def(py::init<const cfd::ReadOptions&>(), py::arg("options"));
 
     m.def("create_mesh_reader", &cfd::create_mesh_reader,
-          "Create appropriate mesh reader based on file extension");
+          "Create appropriate mesh reader based on file extension",
+          py::arg("file_path"), py::arg("options") = cfd::ReadOptions());
     
     m.def("read_nas_file", &cfd::read_nas_file,
           "Convenience function to read NAS files");
+
+    m.def("read_with_stats",
+          [](const std::string& file_path, const cfd::ReadOptions& options) {
+              auto reader = cfd::create_mesh_reader(file_path, options);
+              cfd::MeshData mesh = reader->read(file_path);
+              return py::make_tuple(std::move(mesh), reader->last_stats());
+          },
+          "Read a mesh file and return (MeshData, LoadStats)",
+          py::arg("file_path"), py::arg("options") = cfd::ReadOptions());
+
+    m.def("iter_mesh_blocks",
+          [](const std::string& file_path, size_t block_size, const cfd::ReadOptions& options) {
+              return cfd::create_mesh_reader(file_path, options)->open_stream(file_path, block_size);
+          },
+          "Iterate over a mesh file in blocks of at most block_size vertices or faces",
+          py::arg("file_path"), py::arg("block_size") = size_t(1) << 20,
+          py::arg("options") = cfd::ReadOptions());
+
+    // Accessors return read-only NumPy views of the mapped cache file
+    py::class_<cfd::MeshCache>(m, "MeshCache")
+        .def(py::init<const std::string&>(), py::arg("cache_path"))
+        .def("is_fresh", &cfd::MeshCache::is_fresh,
+             py::arg("source_path"), py::arg("options") = cfd::ReadOptions())
+        .def_property_readonly("vertices", &cfd::MeshCache::vertices, py::return_value_policy::reference_internal)
+        .def_property_readonly("faces", &cfd::MeshCache::faces, py::return_value_policy::reference_internal)
+        .def_property_readonly("normals", &cfd::MeshCache::normals, py::return_value_policy::reference_internal)
+        .def_property_readonly("quads", &cfd::MeshCache::quads, py::return_value_policy::reference_internal)
+        .def_property_readonly("has_topology", &cfd::MeshCache::has_topology)
+        .def_property_readonly("edges", &cfd::MeshCache::edges, py::return_value_policy::reference_internal)
+        .def_property_readonly("edge_face_offsets", &cfd::MeshCache::edge_face_offsets,
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("edge_faces", &cfd::MeshCache::edge_faces, py::return_value_policy::reference_internal)
+        .def_property_readonly("solids", &cfd::MeshCache::solids)
+        .def_property_readonly("bbox_min", &cfd::MeshCache::bbox_min)
+        .def_property_readonly("bbox_max", &cfd::MeshCache::bbox_max)
+        .def("to_mesh_data", &cfd::MeshCache::to_mesh_data);
+
+    m.def("mesh_cache_path", &cfd::mesh_cache_path,
+          "Path of the binary cache belonging to a mesh file", py::arg("source_path"));
+
+    m.def("write_mesh_cache", &cfd::write_mesh_cache,
+          "Write the binary cache for a mesh, optionally with edge/adjacency tables",
+          py::arg("cache_path"), py::arg("source_path"), py::arg("mesh"),
+          py::arg("options") = cfd::ReadOptions(), py::arg("include_topology") = false);
+
+    py::class_<cfd::WriteOptions>(m, "WriteOptions")
+        .def(py::init<>())
+        .def_readwrite("num_threads", &cfd::WriteOptions::num_threads)
+        .def_readwrite("ascii_stl", &cfd::WriteOptions::ascii_stl)
+        .def_readwrite("nas_large_field", &cfd::WriteOptions::nas_large_field)
+        .def_readwrite("solid_name", &cfd::WriteOptions::solid_name)
+        .def_readwrite("quantization_bits", &cfd::WriteOptions::quantization_bits);
+
+    py::class_<cfd::MeshWriter, std::unique_ptr<cfd::MeshWriter>>(m, "MeshWriter")
+        .def("write", &cfd::MeshWriter::write, py::arg("mesh"), py::arg("file_path"),
+             py::call_guard<py::gil_scoped_release>());
+
+    py::class_<cfd::STLWriter, cfd::MeshWriter>(m, "STLWriter")
+        .def(py::init<>())
+        .def(py::init<const cfd::WriteOptions&>(), py::arg("options"));
+
+    py::class_<cfd::NASWriter, cfd::MeshWriter>(m, "NASWriter")
+        .def(py::init<>())
+        .def(py::init<const cfd::WriteOptions&>(), py::arg("options"));
+
+    py::class_<cfd::CMZWriter, cfd::MeshWriter>(m, "CMZWriter")
+        .def(py::init<>())
+        .def(py::init<const cfd::WriteOptions&>(), py::arg("options"));
+
+    m.def("create_mesh_writer", &cfd::create_mesh_writer,
+          "Create appropriate mesh writer based on file extension",
+          py::arg("file_path"), py::arg("options") = cfd::WriteOptions());
+
+    m.def("write_mesh", &cfd::write_mesh,
+          "Write a mesh in the format given by the file extension",
+          py::arg("mesh"), py::arg("file_path"), py::arg("options") = cfd::WriteOptions(),
+          py::call_guard<py::gil_scoped_release>());
+
+    // Returns a new MeshData: welding in place would reallocate the buffers
+    // behind views already handed out for mesh
+    m.def("weld_vertices", [](const cfd::MeshData& mesh, float tolerance) {
+              cfd::MeshData welded = mesh;
+              cfd::weld_vertices(welded, tolerance);
+              return welded;
+          },
+          "Copy of mesh with coincident vertices merged and faces remapped onto them",
+          py::arg("mesh"), py::arg("tolerance") = 0.0f,
+          py::call_guard<py::gil_scoped_release>());
 } 
\ No newline at end of file
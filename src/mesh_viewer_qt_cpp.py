@@ -43,9 +43,9 @@ class MeshViewerQtCpp(MeshViewerQt):
         if self.using_cpp and CPP_MODULE_AVAILABLE:
             # 使用C++实现
             try:
-                cpp_result, cpp_time = free_edges_cpp.detect_free_edges_with_timing(self.mesh_data['faces'].tolist())
+                cpp_result, cpp_time = free_edges_cpp.detect_free_edges_with_timing(self.mesh_data['faces'])
                 # 将C++结果转换为Python格式
-                self.selected_edges = [tuple(edge) for edge in cpp_result]
+                self.selected_edges = [tuple(edge) for edge in cpp_result.tolist()]
                 execution_time = cpp_time  # 使用C++内部计时
             except Exception as e:
                 print(f"C++实现出错，回退到Python实现: {e}")
@@ -0,0 +1,392 @@
+#include "mesh_writer.hpp"
+#include "parallel_utils.hpp"
+#include "text_parse.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cfd {
+
+namespace {
+
+void write_file(const std::string& file_path, const std::vector<const std::string*>& parts) {
+    std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create file: " + file_path);
+    }
+    for (const std::string* part : parts) {
+        out.write(part->data(), std::streamsize(part->size()));
+    }
+    if (!out) {
+        throw std::runtime_error("Cannot write file: " + file_path);
+    }
+}
+
+void check_mesh(const MeshData& mesh) {
+    if ((mesh.vertices.size() > 0 && mesh.vertices.cols() != 3) ||
+        (mesh.faces.size() > 0 && mesh.faces.cols() != 3) ||
+        (mesh.quads.size() > 0 && mesh.quads.cols() != 4)) {
+        throw std::runtime_error("MeshData arrays must be Nx3 vertices, Mx3 faces and Kx4 quads");
+    }
+}
+
+// Element rows [begin, end) of `cells` must reference existing vertices
+void check_indices(const RowMatrixXi& cells, size_t begin, size_t end, Eigen::Index vertex_count) {
+    const int* p = cells.data() + begin * size_t(cells.cols());
+    const int* const p_end = cells.data() + end * size_t(cells.cols());
+    for (; p < p_end; ++p) {
+        if (*p < 0 || *p >= vertex_count) {
+            throw std::runtime_error("Face references vertex " + std::to_string(*p) +
+                                     " but the mesh has " + std::to_string(vertex_count) +
+                                     " vertices");
+        }
+    }
+}
+
+Eigen::Vector3f face_normal(const MeshData& mesh, Eigen::Index f) {
+    if (mesh.normals.rows() == mesh.faces.rows()) {
+        return mesh.normals.row(f).transpose();
+    }
+    const Eigen::Vector3f a = mesh.vertices.row(mesh.faces(f, 0)).transpose();
+    const Eigen::Vector3f b = mesh.vertices.row(mesh.faces(f, 1)).transpose();
+    const Eigen::Vector3f c = mesh.vertices.row(mesh.faces(f, 2)).transpose();
+    const Eigen::Vector3f n = (b - a).cross(c - a);
+    const float length = n.norm();
+    return length > 0.0f ? Eigen::Vector3f(n / length) : Eigen::Vector3f::Zero();
+}
+
+// Shortest text that reads back as the same float
+void append_float(std::string& out, float value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void append_vector(std::string& out, const char* prefix, const Eigen::Vector3f& v) {
+    out += prefix;
+    for (int k = 0; k < 3; ++k) {
+        out += ' ';
+        append_float(out, v[k]);
+    }
+    out += '\n';
+}
+
+// Fills [out, out + width) with `text` left-justified and blank padded
+void put_field(char* out, int width, const char* text, size_t length) {
+    std::memcpy(out, text, length);
+    std::memset(out + length, ' ', size_t(width) - length);
+}
+
+void put_int_field(char* out, int width, int value) {
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    put_field(out, width, buffer, size_t(result.ptr - buffer));
+}
+
+// Fixed notation with as many decimals as fit, without the leading zero of
+// values below 1 (".00125"). Returns 0 when the value does not fit.
+size_t format_fixed_real(double value, int width, char* out) {
+    const double magnitude = std::fabs(value);
+    const int int_digits = magnitude >= 1.0 ? int(std::floor(std::log10(magnitude))) + 1 : 0;
+    int decimals = width - int_digits - 1 - (value < 0 ? 1 : 0);
+    for (; decimals >= 0; --decimals) {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed,
+                                    decimals);
+        char* begin = buffer;
+        char* end = result.ptr;
+        if (decimals == 0) *end++ = '.';
+        // "-0.5" -> "-.5", "0.5" -> ".5"
+        char* digits = begin + (*begin == '-' ? 1 : 0);
+        if (digits + 1 < end && digits[0] == '0' && digits[1] == '.') {
+            std::memmove(digits, digits + 1, size_t(end - digits - 1));
+            --end;
+        }
+        if (end - begin <= width) {
+            std::memcpy(out, begin, size_t(end - begin));
+            return size_t(end - begin);
+        }
+        // Rounding carried into another integer digit (9.99 -> 10.0): retry shorter
+    }
+    return 0;
+}
+
+// NASTRAN exponent notation without the 'E' ("1.2345-3"). Returns 0 when
+// the value does not fit.
+size_t format_exponent_real(double value, int width, char* out) {
+    const double magnitude = std::fabs(value);
+    const int exponent = int(std::floor(std::log10(magnitude)));
+    const int exponent_digits = std::abs(exponent) >= 100 ? 3 : std::abs(exponent) >= 10 ? 2 : 1;
+    int decimals = width - (value < 0 ? 1 : 0) - 2 - 1 - exponent_digits;
+    for (; decimals >= 0; --decimals) {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                    std::chars_format::scientific, decimals);
+        char* e = std::find(buffer, result.ptr, 'e');
+        char text[64];
+        size_t length = size_t(e - buffer);
+        std::memcpy(text, buffer, length);
+        if (decimals == 0) text[length++] = '.';
+        text[length++] = e[1];  // exponent sign
+        const char* exp_digits = e + 2;
+        while (exp_digits + 1 < result.ptr && *exp_digits == '0') ++exp_digits;
+        std::memcpy(text + length, exp_digits, size_t(result.ptr - exp_digits));
+        length += size_t(result.ptr - exp_digits);
+        if (int(length) <= width) {
+            std::memcpy(out, text, length);
+            return length;
+        }
+        // Rounding moved the exponent to more digits (9.99e9 -> 1.0e10): retry shorter
+    }
+    return 0;
+}
+
+// Writes the NASTRAN real closest to `value` that fits in `width` columns:
+// the shortest round-trip text when it fits as a plain decimal, otherwise the
+// better of fixed and exponent notation
+void put_real_field(char* out, int width, float value) {
+    if (value == 0.0f || !std::isfinite(value)) {
+        put_field(out, width, "0.", 2);
+        return;
+    }
+    char shortest[32];
+    const auto result = std::to_chars(shortest, shortest + sizeof(shortest) - 1, value);
+    size_t shortest_length = size_t(result.ptr - shortest);
+    if (std::find(shortest, result.ptr, 'e') == result.ptr) {
+        if (std::find(shortest, result.ptr, '.') == result.ptr) {
+            shortest[shortest_length++] = '.';
+        }
+        if (int(shortest_length) <= width) {
+            put_field(out, width, shortest, shortest_length);
+            return;
+        }
+    }
+
+    char fixed[32];
+    char exponent[32];
+    const size_t fixed_length = format_fixed_real(value, width, fixed);
+    const size_t exponent_length = format_exponent_real(value, width, exponent);
+
+    double fixed_value = 0.0;
+    double exponent_value = 0.0;
+    const bool fixed_ok = fixed_length > 0 && parse_real(fixed, fixed + fixed_length, fixed_value);
+    const bool exponent_ok =
+        exponent_length > 0 && parse_real(exponent, exponent + exponent_length, exponent_value);
+    if (fixed_ok &&
+        (!exponent_ok || std::fabs(fixed_value - value) <= std::fabs(exponent_value - value))) {
+        put_field(out, width, fixed, fixed_length);
+    } else if (exponent_ok) {
+        put_field(out, width, exponent, exponent_length);
+    } else {
+        throw std::runtime_error("Cannot format " + std::to_string(value) + " as a NASTRAN real");
+    }
+}
+
+} // namespace
+
+void STLWriter::write(const MeshData& mesh, const std::string& file_path) {
+    check_mesh(mesh);
+    parallel_for(0, size_t(mesh.faces.rows()), 1 << 16, [&](size_t begin, size_t end) {
+        check_indices(mesh.faces, begin, end, mesh.vertices.rows());
+    }, options_.num_threads);
+
+    if (options_.ascii_stl) {
+        write_ascii(mesh, file_path);
+    } else {
+        write_binary(mesh, file_path);
+    }
+}
+
+void STLWriter::write_binary(const MeshData& mesh, const std::string& file_path) {
+    constexpr size_t kHeaderSize = 84;
+    constexpr size_t kRecordSize = 50;
+
+    const size_t face_count = size_t(mesh.faces.rows());
+    if (face_count > UINT32_MAX) {
+        throw std::runtime_error("Too many faces for a binary STL file: " + file_path);
+    }
+
+    std::string buffer(kHeaderSize + kRecordSize * face_count, '\0');
+    static const char kHeader[] = "binary STL written by mesh_writer";
+    std::memcpy(&buffer[0], kHeader, sizeof(kHeader) - 1);
+    const uint32_t count = uint32_t(face_count);
+    std::memcpy(&buffer[80], &count, sizeof(count));
+
+    char* records = &buffer[kHeaderSize];
+    parallel_for(0, face_count, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float values[12];
+            const Eigen::Vector3f normal = face_normal(mesh, Eigen::Index(i));
+            std::copy(normal.data(), normal.data() + 3, values);
+            for (int k = 0; k < 3; ++k) {
+                const float* v = mesh.vertices.data() + size_t(mesh.faces(i, k)) * 3;
+                std::copy(v, v + 3, values + 3 + 3 * k);
+            }
+            // The trailing 2-byte attribute count stays zero
+            std::memcpy(records + i * kRecordSize, values, sizeof(values));
+        }
+    }, options_.num_threads);
+
+    write_file(file_path, {&buffer});
+}
+
+void STLWriter::write_ascii(const MeshData& mesh, const std::string& file_path) {
+    const size_t face_count = size_t(mesh.faces.rows());
+
+    // Solid ranges are kept when they tile the faces in order, otherwise
+    // everything goes into one solid
+    std::vector<SolidRange> solids;
+    size_t covered = 0;
+    for (const SolidRange& solid : mesh.solids) {
+        if (solid.first_face != covered) break;
+        covered += solid.face_count;
+    }
+    if (!mesh.solids.empty() && covered == face_count) {
+        solids = mesh.solids;
+    } else {
+        solids.push_back(SolidRange{options_.solid_name, 0, face_count});
+    }
+
+    std::vector<std::string> parts;
+    for (const SolidRange& solid : solids) {
+        parts.push_back("solid " + solid.name + "\n");
+
+        const size_t first = parts.size();
+        const size_t end_face = solid.first_face + solid.face_count;
+        parts.resize(first + parallel_chunk_count(solid.face_count, 1 << 14, options_.num_threads));
+        parallel_for_chunks(solid.first_face, end_face, 1 << 14,
+                            [&](size_t chunk, size_t begin, size_t end) {
+            std::string& out = parts[first + chunk];
+            out.reserve((end - begin) * 260);
+            for (size_t f = begin; f < end; ++f) {
+                append_vector(out, "  facet normal", face_normal(mesh, Eigen::Index(f)));
+                out += "    outer loop\n";
+                for (int k = 0; k < 3; ++k) {
+                    append_vector(out, "      vertex",
+                                  mesh.vertices.row(mesh.faces(Eigen::Index(f), k)).transpose());
+                }
+                out += "    endloop\n  endfacet\n";
+            }
+        }, options_.num_threads);
+
+        parts.push_back("endsolid " + solid.name + "\n");
+    }
+
+    std::vector<const std::string*> views;
+    for (const std::string& part : parts) {
+        views.push_back(&part);
+    }
+    write_file(file_path, views);
+}
+
+void NASWriter::write(const MeshData& mesh, const std::string& file_path) {
+    check_mesh(mesh);
+
+    // Every card has a fixed length, so each row is formatted straight into
+    // its slot of one preallocated buffer
+    const bool large = options_.nas_large_field;
+    const int width = large ? 16 : 8;
+    const size_t grid_length = large ? 8 + 4 * 16 + 1 + 8 + 16 + 1 : 8 + 5 * 8 + 1;
+    const size_t tria_length = large ? 8 + 4 * 16 + 1 + 8 + 16 + 1 : 8 + 5 * 8 + 1;
+    const size_t quad_length = large ? 8 + 4 * 16 + 1 + 8 + 2 * 16 + 1 : 8 + 6 * 8 + 1;
+
+    const size_t vertex_count = size_t(mesh.vertices.rows());
+    const size_t face_count = size_t(mesh.faces.rows());
+    const size_t quad_count = size_t(mesh.quads.rows());
+    const size_t max_id = std::max(vertex_count, face_count + quad_count);
+    if (max_id > (large ? size_t(INT32_MAX) : size_t(99999999))) {
+        throw std::runtime_error("Too many vertices or elements for " +
+                                 std::string(large ? "NASTRAN ids" : "small field cards") +
+                                 ": " + file_path);
+    }
+
+    static const std::string kBegin = "BEGIN BULK\n";
+    static const std::string kEnd = "ENDDATA\n";
+    std::string body(vertex_count * grid_length + face_count * tria_length +
+                         quad_count * quad_length,
+                     ' ');
+    char* grids = &body[0];
+    char* trias = grids + vertex_count * grid_length;
+    char* quads = trias + face_count * tria_length;
+
+    // Writes the card name and the first-line fields; with large fields the
+    // fields past the fourth go to a "*" continuation line
+    auto put_card = [&](char* out, const char* name, const float* reals, const int* ints,
+                        int field_count) {
+        std::memcpy(out, name, std::strlen(name));
+        char* field = out + 8;
+        for (int k = 0; k < field_count; ++k) {
+            if (large && k == 4) {
+                *field++ = '\n';
+                *field = '*';
+                field += 8;
+            }
+            if (reals != nullptr && k >= 2) {
+                put_real_field(field, width, reals[k - 2]);
+            } else if (ints[k] != 0 || reals == nullptr) {
+                put_int_field(field, width, ints[k]);
+            }
+            field += width;
+        }
+        *field = '\n';
+    };
+
+    parallel_for(0, vertex_count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const int ids[2] = {int(i + 1), 0};  // blank CP
+            put_card(grids + i * grid_length, large ? "GRID*" : "GRID",
+                     mesh.vertices.data() + i * 3, ids, 5);
+        }
+    }, options_.num_threads);
+
+    parallel_for(0, face_count, 1 << 14, [&](size_t begin, size_t end) {
+        check_indices(mesh.faces, begin, end, mesh.vertices.rows());
+        for (size_t i = begin; i < end; ++i) {
+            const int ids[5] = {int(i + 1), 1, mesh.faces(i, 0) + 1, mesh.faces(i, 1) + 1,
+                                mesh.faces(i, 2) + 1};
+            put_card(trias + i * tria_length, large ? "CTRIA3*" : "CTRIA3", nullptr, ids, 5);
+        }
+    }, options_.num_threads);
+
+    parallel_for(0, quad_count, 1 << 14, [&](size_t begin, size_t end) {
+        check_indices(mesh.quads, begin, end, mesh.vertices.rows());
+        for (size_t i = begin; i < end; ++i) {
+            const int ids[6] = {int(face_count + i + 1), 1, mesh.quads(i, 0) + 1,
+                                mesh.quads(i, 1) + 1, mesh.quads(i, 2) + 1, mesh.quads(i, 3) + 1};
+            put_card(quads + i * quad_length, large ? "CQUAD4*" : "CQUAD4", nullptr, ids, 6);
+        }
+    }, options_.num_threads);
+
+    write_file(file_path, {&kBegin, &body, &kEnd});
+}
+
+std::unique_ptr<MeshWriter> create_mesh_writer(const std::string& file_path,
+                                               const WriteOptions& options) {
+    std::string ext = file_path.substr(file_path.find_last_of(".") + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == "nas") {
+        return std::make_unique<NASWriter>(options);
+    }
+    else if (ext == "stl") {
+        return std::make_unique<STLWriter>(options);
+    }
+    else if (ext == "cmz") {
+        return std::make_unique<CMZWriter>(options);
+    }
+    else {
+        throw std::runtime_error("Unsupported file format: " + ext);
+    }
+}
+
+void write_mesh(const MeshData& mesh, const std::string& file_path, const WriteOptions& options) {
+    create_mesh_writer(file_path, options)->write(mesh, file_path);
+}
+
+} // namespace cfd
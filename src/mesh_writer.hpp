@@ -0,0 +1,81 @@
+#ifndef MESH_WRITER_HPP
+#define MESH_WRITER_HPP
+
+#include "mesh_reader.hpp"
+#include <memory>
+#include <string>
+
+namespace cfd {
+
+// Options controlling how meshes are exported
+struct WriteOptions {
+    unsigned num_threads = 0;         // Worker threads for serialization (0 = all cores)
+    bool ascii_stl = false;           // Write ASCII instead of binary STL
+    bool nas_large_field = false;     // Write GRID*/CTRIA3*/CQUAD4* 16-column cards
+    std::string solid_name = "mesh";  // ASCII STL solid name when MeshData::solids is empty
+    int quantization_bits = 20;       // CMZ coordinate precision: bounding box / 2^bits
+};
+
+// Writers serialize the mesh in parallel chunks into memory buffers and hand
+// them to the file in a few large writes
+class MeshWriter {
+public:
+    virtual ~MeshWriter() = default;
+    virtual void write(const MeshData& mesh, const std::string& file_path) = 0;
+};
+
+// Binary or ASCII STL. Face normals come from MeshData::normals when present,
+// otherwise they are computed from the vertices. ASCII output keeps the
+// solids of MeshData::solids when they cover all faces in order.
+class STLWriter : public MeshWriter {
+public:
+    STLWriter() = default;
+    explicit STLWriter(const WriteOptions& options) : options_(options) {}
+
+    void write(const MeshData& mesh, const std::string& file_path) override;
+
+private:
+    void write_binary(const MeshData& mesh, const std::string& file_path);
+    void write_ascii(const MeshData& mesh, const std::string& file_path);
+
+    WriteOptions options_;
+};
+
+// NASTRAN bulk data: one GRID per vertex (id = index + 1), then CTRIA3 for
+// faces and CQUAD4 for quads with consecutive element ids and property 1
+class NASWriter : public MeshWriter {
+public:
+    NASWriter() = default;
+    explicit NASWriter(const WriteOptions& options) : options_(options) {}
+
+    void write(const MeshData& mesh, const std::string& file_path) override;
+
+private:
+    WriteOptions options_;
+};
+
+// Block-compressed container read by CMZReader. Coordinates are quantized on
+// the bounding box to quantization_bits and delta encoded, face and quad
+// indices are delta encoded, all as variable-length integers in independent
+// blocks that are encoded in parallel. Throws std::runtime_error for NaN or
+// infinite vertex and normal coordinates, which have no quantized value.
+class CMZWriter : public MeshWriter {
+public:
+    CMZWriter() = default;
+    explicit CMZWriter(const WriteOptions& options) : options_(options) {}
+
+    void write(const MeshData& mesh, const std::string& file_path) override;
+
+private:
+    WriteOptions options_;
+};
+
+// Picks the writer from the file extension (.stl, .nas or .cmz)
+std::unique_ptr<MeshWriter> create_mesh_writer(const std::string& file_path,
+                                               const WriteOptions& options = WriteOptions());
+void write_mesh(const MeshData& mesh, const std::string& file_path,
+                const WriteOptions& options = WriteOptions());
+
+} // namespace cfd
+
+#endif // MESH_WRITER_HPP
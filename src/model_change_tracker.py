@@ -130,6 +130,12 @@ class ModelChangeTracker:
         
         # 存储每次分析的耗时
         self.last_analysis_times = {}
+        
+        # 完整分析期间各检测共享的C++网格句柄（缓存边表、包围盒等拓扑）
+        self.core_mesh = None
+        
+        # 面质量增量分析器：保存每个面片的质量和低质量面片集合，局部修改后只重算受影响的面片
+        self.quality_tracker = None
     
     def initialize_cache(self):
         """初始化缓存，完整分析整个模型"""
@@ -236,8 +242,31 @@ class ModelChangeTracker:
                         if other_face_id != face_id:
                             face_conn["faces"].add(other_face_id)
     
+    def _create_core_mesh(self):
+        """由当前网格数据创建共享的C++ Mesh句柄，模块不可用或数据无效时返回None"""
+        mesh_data = self.mesh_viewer.mesh_data
+        if not mesh_data or 'vertices' not in mesh_data or 'faces' not in mesh_data:
+            return None
+        try:
+            import mesh_reader_cpp
+            return mesh_reader_cpp.Mesh(np.asarray(mesh_data['vertices']), np.asarray(mesh_data['faces']))
+        except (ImportError, AttributeError):
+            return None
+        except Exception as e:
+            print(f"警告: 创建共享网格句柄失败，各检测将各自转换数据: {str(e)}")
+            return None
+    
     def _compute_full_analysis(self):
         """计算完整分析结果"""
+        # 所有检测共用一个Mesh句柄，边表等拓扑只构建一次
+        self.core_mesh = self._create_core_mesh()
+        try:
+            self._run_full_analysis()
+        finally:
+            self.core_mesh = None
+    
+    def _run_full_analysis(self):
+        """依次执行各项检测并更新缓存"""
         # 调用mesh_viewer中的分析方法，并保存完整结果
         intersections = self._analyze_face_intersections()
         
@@ -655,13 +684,18 @@ class ModelChangeTracker:
             algorithm.use_cpp = has_cpp
             algorithm.target_faces = affected_area["faces"]
             algorithm.enhanced_cpp_available = hasattr(self.mesh_viewer, 'has_enhanced_pierced_faces') and self.mesh_viewer.has_enhanced_pierced_faces
+            algorithm.core_mesh = self.core_mesh
 
             # 传递 parent=None 以抑制对话框
             result = algorithm.execute(parent=None)
             return result.get('selected_faces', []) if result else []
     
     def _analyze_face_quality(self, affected_area=None):
-        """分析面质量问题 (强制使用C++) """
+        """分析面质量问题 (强制使用C++) 
+        
+        完整分析时建立QualityTracker；局部修改后只重新计算受影响的面片和受影响点周围的面片，
+        返回整个模型的低质量面片列表
+        """
         # 检查 C++ 模块
         try:
             import face_quality_cpp
@@ -670,14 +704,45 @@ class ModelChangeTracker:
             print("错误：未找到 face_quality_cpp 模块，无法执行面质量分析。")
             return [] # 返回空列表表示失败
 
+        threshold = getattr(self.mesh_viewer, 'face_quality_threshold', 0.3)
+        if not threshold: return [] # 如果没有有效阈值，直接返回
+
+        mesh_data = self.mesh_viewer.mesh_data
+        if hasattr(face_quality_cpp, 'QualityTracker') and mesh_data and 'vertices' in mesh_data and 'faces' in mesh_data:
+            vertices = np.asarray(mesh_data['vertices'])
+            faces = np.asarray(mesh_data['faces'])
+            tracker = self.quality_tracker
+            if affected_area is None or tracker is None or tracker.threshold != threshold:
+                tracker = None
+            else:
+                try:
+                    tracker.update(vertices, faces,
+                                   face_ids=np.fromiter(affected_area.get("faces", ()), dtype=np.int32),
+                                   vertex_ids=np.fromiter(affected_area.get("points", ()), dtype=np.int32))
+                except RuntimeError as e:
+                    # 面片数变化（增删面片）后需要重新建立
+                    print(f"面质量增量更新不可用，重新计算全部面片: {str(e)}")
+                    tracker = None
+            if tracker is None:
+                try:
+                    if self.core_mesh is not None:
+                        tracker = face_quality_cpp.QualityTracker(self.core_mesh, threshold)
+                    else:
+                        tracker = face_quality_cpp.QualityTracker(vertices, faces, threshold)
+                except Exception as e:
+                    print(f"警告: 建立面质量增量分析器失败，改用完整分析: {str(e)}")
+                self.quality_tracker = tracker
+            if tracker is not None:
+                return tracker.low_faces().tolist()
+
         # 创建算法实例并强制使用 C++
-        algorithm = FaceQualityAlgorithm(self.mesh_viewer.mesh_data)
+        algorithm = FaceQualityAlgorithm(mesh_data)
         algorithm.use_cpp = True # 强制使用C++
+        algorithm.core_mesh = self.core_mesh
+        algorithm.threshold = threshold
         # 如果提供了 affected_area，限制目标面
         if affected_area and 'faces' in affected_area:
             algorithm.target_faces = affected_area["faces"]
-        threshold = getattr(self.mesh_viewer, 'face_quality_threshold', 0.3)
-        if not threshold: return [] # 如果没有有效阈值，直接返回
 
         # 传递 parent=None 以抑制对话框
         result = algorithm.execute(parent=None)
@@ -695,6 +760,7 @@ class ModelChangeTracker:
             
         algorithm = FreeEdgesAlgorithm(self.mesh_viewer.mesh_data)
         algorithm.use_cpp = True # 强制使用C++
+        algorithm.core_mesh = self.core_mesh
         # 如果提供了affected_area，限制目标边
         if affected_area and 'edges' in affected_area:
              algorithm.target_edges = affected_area["edges"]
@@ -718,6 +784,7 @@ class ModelChangeTracker:
         # 创建算法实例
         algorithm = OverlappingEdgesAlgorithm(self.mesh_viewer.mesh_data)
         algorithm.use_cpp = True  # 强制使用C++
+        algorithm.core_mesh = self.core_mesh
         
         # 如果提供了affected_area，限制目标边
         if affected_area and 'edges' in affected_area:
@@ -753,6 +820,7 @@ class ModelChangeTracker:
         # 使用合并后的顶点检测算法，并强制使用C++
         algorithm = MergedVertexDetectionAlgorithm(self.mesh_viewer.mesh_data, detection_mode="overlapping")
         algorithm.use_cpp = True  # 强制使用C++
+        algorithm.core_mesh = self.core_mesh
         
         # 如果提供了affected_area，限制目标点
         if affected_area and 'points' in affected_area:
@@ -803,14 +871,17 @@ class ModelChangeTracker:
             import adjacent_faces_cpp
             print("使用C++模块进行相邻面分析")
             
-            # 准备数据
-            vertices_np = np.array(self.mesh_viewer.mesh_data['vertices'], dtype=np.float32)
-            faces_np = np.array(self.mesh_viewer.mesh_data['faces'], dtype=np.int32)
-            
-            # 调用C++函数 (总是进行全量分析)
-            adjacent_pairs, execution_time_cpp = adjacent_faces_cpp.detect_adjacent_faces_with_timing(
-                vertices_np, faces_np, proximity_threshold=float(threshold)
-            )
+            # 调用C++函数 (总是进行全量分析)，有共享Mesh时直接复用
+            if self.core_mesh is not None:
+                adjacent_pairs, execution_time_cpp = adjacent_faces_cpp.detect_adjacent_faces_with_timing(
+                    self.core_mesh, proximity_threshold=float(threshold)
+                )
+            else:
+                vertices_np = np.array(self.mesh_viewer.mesh_data['vertices'], dtype=np.float32)
+                faces_np = np.array(self.mesh_viewer.mesh_data['faces'], dtype=np.int32)
+                adjacent_pairs, execution_time_cpp = adjacent_faces_cpp.detect_adjacent_faces_with_timing(
+                    vertices_np, faces_np, proximity_threshold=float(threshold)
+                )
             
             # 处理结果
             face_set = set()
@@ -1,98 +1,241 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include <algorithm>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
-#include <stack>
 #include <chrono>
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
+#include "parallel_utils.hpp"
 
 namespace py = pybind11;
 
-// Define edge as a pair of ints
-typedef std::pair<int, int> Edge;
+// 每个线程块至少处理的顶点数
+constexpr size_t kVertexGrain = 1 << 12;
 
-// Edge hash function
-struct EdgeHash {
-    std::size_t operator()(const Edge& e) const {
-        return std::hash<int>()(e.first) ^ (std::hash<int>()(e.second) << 1);
-    }
+// 顶点周围的扇区分析结果（每个顶点一项）
+struct VertexFans {
+    std::vector<int32_t> fan_count;                // 按边相连的面片扇区数
+    std::vector<int32_t> free_edge_count;          // 连接的自由边数
+    std::vector<uint8_t> has_non_manifold_edge;    // 是否连接被两个以上面片共用的边
 };
 
-// Edge equality function
-struct EdgeEqual {
-    bool operator()(const Edge& e1, const Edge& e2) const {
-        return e1.first == e2.first && e1.second == e2.second;
-    }
-};
+// 顶点v所在的面片取自Mesh缓存的顶点→面片CSR表。v的每个面片贡献两条"辐条"
+// (v, w)；两个面片共用同一条辐条时连通。用并查集统计连通的扇区数，同时统计
+// 只被一个面片使用的辐条（自由边）。各顶点相互独立，按顶点区间分给各个线程。
+VertexFans analyze_vertex_fans(const cfd::Mesh& mesh) {
+    const cfd::Incidence& vertex_faces = mesh.vertex_faces();
+    const size_t num_vertices = mesh.num_vertices();
+
+    VertexFans fans;
+    fans.fan_count.assign(num_vertices, 0);
+    fans.free_edge_count.assign(num_vertices, 0);
+    fans.has_non_manifold_edge.assign(num_vertices, 0);
+
+    cfd::parallel_for(0, num_vertices, kVertexGrain, [&](size_t begin, size_t end) {
+        std::vector<std::pair<int32_t, int32_t>> spokes;  // (相邻顶点w, 面片在v的面片列表中的序号)
+        std::vector<int32_t> parent;
+        auto find = [&](int32_t i) {
+            while (parent[size_t(i)] != i) {
+                parent[size_t(i)] = parent[size_t(parent[size_t(i)])];
+                i = parent[size_t(i)];
+            }
+            return i;
+        };
+
+        for (size_t v = begin; v < end; ++v) {
+            const size_t count = vertex_faces.count(v);
+            spokes.clear();
+            parent.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                parent[i] = int32_t(i);
+                for (int32_t w : mesh.face(size_t(vertex_faces.begin(v)[i]))) {
+                    if (size_t(w) != v) {
+                        spokes.emplace_back(w, int32_t(i));
+                    }
+                }
+            }
+            std::sort(spokes.begin(), spokes.end());
+            // 退化面片会重复贡献同一条辐条，只计一次
+            spokes.erase(std::unique(spokes.begin(), spokes.end()), spokes.end());
+
+            int32_t components = int32_t(count);
+            for (size_t a = 0; a < spokes.size();) {
+                size_t b = a + 1;
+                while (b < spokes.size() && spokes[b].first == spokes[a].first) {
+                    ++b;
+                }
+                if (b - a == 1) {
+                    fans.free_edge_count[v]++;
+                } else if (b - a > 2) {
+                    fans.has_non_manifold_edge[v] = 1;
+                }
+                for (size_t k = a + 1; k < b; ++k) {
+                    const int32_t ra = find(spokes[a].second);
+                    const int32_t rb = find(spokes[k].second);
+                    if (ra != rb) {
+                        parent[size_t(rb)] = ra;
+                        --components;
+                    }
+                }
+                a = b;
+            }
+            fans.fan_count[v] = components;
+        }
+    });
+    return fans;
+}
 
 // Non-manifold vertex detection implementation
 // 非流形顶点检测实现
 // 定义：当一个点连接了4条（包括4条）以上的自由边时，这个点就是重叠点
-std::pair<std::vector<int>, double> detect_non_manifold_vertices_with_timing(
-    py::array_t<double> vertices,
-    py::array_t<int> faces,
-    double tolerance) {
-    
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // Get vertex and face data
-    auto vertices_buf = vertices.request();
-    auto faces_buf = faces.request();
-    
-    double* vertices_ptr = static_cast<double*>(vertices_buf.ptr);
-    int* faces_ptr = static_cast<int*>(faces_buf.ptr);
-    
-    int num_vertices = vertices_buf.shape[0];
-    int num_faces = faces_buf.shape[0];
-    
-    // 步骤1：找出所有边及其连接的面片数量
-    std::unordered_map<Edge, std::vector<int>, EdgeHash, EdgeEqual> edges;
-    for (int face_idx = 0; face_idx < num_faces; ++face_idx) {
-        for (int i = 0; i < 3; ++i) {
-            int v1 = faces_ptr[face_idx * 3 + i];
-            int v2 = faces_ptr[face_idx * 3 + (i + 1) % 3];
-            Edge edge(std::min(v1, v2), std::max(v1, v2));
-            edges[edge].push_back(face_idx);
+// 自由边数取自扇区分析，多个检测共用同一个Mesh时顶点→面片表只构建一次
+std::vector<int> detect_non_manifold_vertices(const cfd::Mesh& mesh) {
+    const VertexFans fans = analyze_vertex_fans(mesh);
+    std::vector<int> non_manifold_vertices;
+    for (size_t v = 0; v < fans.free_edge_count.size(); ++v) {
+        if (fans.free_edge_count[v] >= 4) {  // 定义：连接4条或以上自由边的点是非流形顶点
+            non_manifold_vertices.push_back(int(v));
         }
     }
-    
-    // 步骤2：找出自由边（只连接了一个面片的边）
-    std::unordered_set<Edge, EdgeHash, EdgeEqual> free_edges;
-    for (const auto& pair : edges) {
-        if (pair.second.size() == 1) {
-            free_edges.insert(pair.first);
+    return non_manifold_vertices;
+}
+
+// 真正的非流形顶点：周围的面片构成两个以上的扇区（例如两个实体只在该点相接），
+// 或者该点连接了被两个以上面片共用的边
+std::vector<int> detect_non_manifold_vertices_by_fans(const cfd::Mesh& mesh) {
+    const VertexFans fans = analyze_vertex_fans(mesh);
+    std::vector<int> non_manifold_vertices;
+    for (size_t v = 0; v < fans.fan_count.size(); ++v) {
+        if (fans.fan_count[v] > 1 || fans.has_non_manifold_edge[v]) {
+            non_manifold_vertices.push_back(int(v));
         }
     }
-    
-    // 步骤3：计算每个顶点连接的自由边数量
-    std::unordered_map<int, int> vertex_free_edge_count;
-    for (const Edge& edge : free_edges) {
-        vertex_free_edge_count[edge.first]++;
-        vertex_free_edge_count[edge.second]++;
+    return non_manifold_vertices;
+}
+
+// tolerance参数保留以兼容旧接口，拓扑检测不使用它
+std::pair<std::vector<int>, double> detect_non_manifold_vertices_mesh_with_timing(
+    const cfd::Mesh& mesh,
+    double /*tolerance*/) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<int> non_manifold_vertices = detect_non_manifold_vertices(mesh);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double detection_time = std::chrono::duration<double>(end_time - start_time).count();
+
+    return std::make_pair(non_manifold_vertices, detection_time);
+}
+
+std::pair<std::vector<int>, double> detect_non_manifold_vertices_with_timing(
+    py::array vertices,
+    py::array faces,
+    double /*tolerance*/) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    const cfd::Mesh mesh = cfd::mesh_from_arrays(vertices, faces);
+    std::vector<int> non_manifold_vertices;
+    {
+        py::gil_scoped_release release;
+        non_manifold_vertices = detect_non_manifold_vertices(mesh);
     }
-    
-    // 步骤4：找出连接了4条或以上自由边的顶点
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double detection_time = std::chrono::duration<double>(end_time - start_time).count();
+
+    return std::make_pair(non_manifold_vertices, detection_time);
+}
+
+std::pair<std::vector<int>, double> detect_non_manifold_vertices_fans_mesh_with_timing(
+    const cfd::Mesh& mesh) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<int> non_manifold_vertices = detect_non_manifold_vertices_by_fans(mesh);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double detection_time = std::chrono::duration<double>(end_time - start_time).count();
+
+    return std::make_pair(non_manifold_vertices, detection_time);
+}
+
+std::pair<std::vector<int>, double> detect_non_manifold_vertices_fans_with_timing(
+    py::array vertices,
+    py::array faces) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    const cfd::Mesh mesh = cfd::mesh_from_arrays(vertices, faces);
     std::vector<int> non_manifold_vertices;
-    for (const auto& pair : vertex_free_edge_count) {
-        if (pair.second >= 4) {  // 定义：连接4条或以上自由边的点是非流形顶点
-            non_manifold_vertices.push_back(pair.first);
-        }
+    {
+        py::gil_scoped_release release;
+        non_manifold_vertices = detect_non_manifold_vertices_by_fans(mesh);
     }
-    
+
     auto end_time = std::chrono::high_resolution_clock::now();
     double detection_time = std::chrono::duration<double>(end_time - start_time).count();
-    
+
     return std::make_pair(non_manifold_vertices, detection_time);
 }
 
+// 每个顶点的扇区数、自由边数和非流形边标记，以NumPy数组返回
+py::dict vertex_fan_arrays(const cfd::Mesh& mesh) {
+    VertexFans fans;
+    {
+        py::gil_scoped_release release;
+        fans = analyze_vertex_fans(mesh);
+    }
+    py::array_t<bool> non_manifold_edge(py::ssize_t(fans.has_non_manifold_edge.size()));
+    std::copy(fans.has_non_manifold_edge.begin(), fans.has_non_manifold_edge.end(),
+              non_manifold_edge.mutable_data());
+    py::dict result;
+    result["fan_count"] = cfd::copy_to_array(fans.fan_count);
+    result["free_edge_count"] = cfd::copy_to_array(fans.free_edge_count);
+    result["non_manifold_edge"] = non_manifold_edge;
+    return result;
+}
+
+py::dict vertex_fan_arrays_from_arrays(py::array vertices, py::array faces) {
+    return vertex_fan_arrays(cfd::mesh_from_arrays(vertices, faces));
+}
+
 PYBIND11_MODULE(non_manifold_vertices_cpp, m) {
     m.doc() = "C++ implementation for non-manifold vertex detection";
-    
-    m.def("detect_non_manifold_vertices_with_timing", 
+
+    // 传入mesh_reader_cpp.Mesh时复用其缓存的顶点→面片表
+    m.def("detect_non_manifold_vertices_with_timing",
+          &detect_non_manifold_vertices_mesh_with_timing,
+          "Detect non-manifold vertices of a shared Mesh and return detection time",
+          py::arg("mesh"),
+          py::arg("tolerance") = 0.0,
+          py::call_guard<py::gil_scoped_release>());
+
+    m.def("detect_non_manifold_vertices_with_timing",
           &detect_non_manifold_vertices_with_timing,
           "Detect non-manifold vertices and return detection time",
           py::arg("vertices"),
           py::arg("faces"),
           py::arg("tolerance"));
-} 
\ No newline at end of file
+
+    // 基于扇区分析的非流形顶点检测
+    m.def("detect_non_manifold_vertices_fans_with_timing",
+          &detect_non_manifold_vertices_fans_mesh_with_timing,
+          "Detect vertices whose faces form more than one fan or that touch an edge "
+          "shared by more than two faces, and return detection time",
+          py::arg("mesh"),
+          py::call_guard<py::gil_scoped_release>());
+
+    m.def("detect_non_manifold_vertices_fans_with_timing",
+          &detect_non_manifold_vertices_fans_with_timing,
+          "Detect vertices whose faces form more than one fan or that touch an edge "
+          "shared by more than two faces, and return detection time",
+          py::arg("vertices"),
+          py::arg("faces"));
+
+    m.def("analyze_vertex_fans", &vertex_fan_arrays,
+          "Per-vertex fan count, free edge count and non-manifold edge flag",
+          py::arg("mesh"));
+    m.def("analyze_vertex_fans", &vertex_fan_arrays_from_arrays,
+          "Per-vertex fan count, free edge count and non-manifold edge flag",
+          py::arg("vertices"),
+          py::arg("faces"));
+}
@@ -2,136 +2,564 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <vector>
-#include <unordered_map>
 #include <tuple>
 #include <cmath>
 #include <chrono>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
+#include "parallel_utils.hpp"
 
 namespace py = pybind11;
 
-// 用于存储边的几何哈希键
-struct EdgeKey {
-    double x1, y1, z1;
-    double x2, y2, z2;
-    
-    EdgeKey(double x1_, double y1_, double z1_, double x2_, double y2_, double z2_)
-        : x1(std::min(x1_, x2_)), y1(std::min(y1_, y2_)), z1(std::min(z1_, z2_)),
-          x2(std::max(x1_, x2_)), y2(std::max(y1_, y2_)), z2(std::max(z1_, z2_)) {}
-    
-    bool operator==(const EdgeKey& other) const {
-        return std::abs(x1 - other.x1) < 1e-5 &&
-               std::abs(y1 - other.y1) < 1e-5 &&
-               std::abs(z1 - other.z1) < 1e-5 &&
-               std::abs(x2 - other.x2) < 1e-5 &&
-               std::abs(y2 - other.y2) < 1e-5 &&
-               std::abs(z2 - other.z2) < 1e-5;
+namespace {
+
+constexpr size_t kGrain = 1 << 14;
+
+// 顶点焊接网格的单元边长为容差的16倍：大多数顶点离单元边界都超过容差，
+// 不需要探测相邻单元
+constexpr double kWeldCellScale = 16.0;
+
+// 焊接网格每个坐标轴最多42位，三轴最多126位，存放在(hi, lo)两个64位字中
+constexpr unsigned kWeldAxisBits = 42;
+
+// 共线检测网格每个坐标轴占21位，三轴打包成一个64位键
+constexpr unsigned kLineAxisBits = 21;
+
+// 对(hi, lo)组成的128位键排序，返回排序后的下标：先按lo做稳定基数排序，
+// 再按hi做稳定基数排序
+std::vector<int32_t> sort_order_128(const std::vector<uint64_t>& hi, std::vector<uint64_t> lo) {
+    std::vector<int32_t> order(hi.size());
+    std::iota(order.begin(), order.end(), 0);
+    cfd::radix_sort_pairs(lo, order);
+    std::vector<uint64_t> hi_sorted(hi.size());
+    cfd::parallel_for(0, hi.size(), kGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hi_sorted[i] = hi[size_t(order[i])];
+        }
+    });
+    cfd::radix_sort_pairs(hi_sorted, order);
+    return order;
+}
+
+struct CellCoord {
+    int64_t x, y, z;
+};
+
+// 把三个单元坐标拼接成最多126位的键(hi, lo)；每轴只占实际需要的位数，
+// 模型较小时整个键落在lo中，高位字的基数排序全部跳过
+struct CellPacker {
+    unsigned y_shift = 0, x_shift = 0;
+
+    static unsigned bit_width(uint64_t v) {
+        unsigned bits = 1;
+        while (bits < 64 && (v >> bits) != 0) ++bits;
+        return bits;
+    }
+
+    // max_cell: 各轴最大单元坐标（探测时会再加1）
+    explicit CellPacker(const CellCoord& max_cell) {
+        y_shift = bit_width(uint64_t(max_cell.z) + 1);
+        x_shift = y_shift + bit_width(uint64_t(max_cell.y) + 1);
+    }
+
+    static void put(uint64_t v, unsigned shift, uint64_t& hi, uint64_t& lo) {
+        if (shift >= 64) {
+            hi |= v << (shift - 64);
+            return;
+        }
+        lo |= v << shift;
+        if (shift > 0) hi |= v >> (64 - shift);
+    }
+
+    void pack(const CellCoord& c, uint64_t& hi, uint64_t& lo) const {
+        hi = lo = 0;
+        put(uint64_t(c.z), 0, hi, lo);
+        put(uint64_t(c.y), y_shift, hi, lo);
+        put(uint64_t(c.x), x_shift, hi, lo);
     }
 };
 
-// 自定义哈希函数
-namespace std {
-    template<>
-    struct hash<EdgeKey> {
-        std::size_t operator()(const EdgeKey& k) const {
-            // 四舍五入到指定精度
-            int precision = 5;
-            double scale = std::pow(10, precision);
-            
-            long long ix1 = std::llround(k.x1 * scale);
-            long long iy1 = std::llround(k.y1 * scale);
-            long long iz1 = std::llround(k.z1 * scale);
-            long long ix2 = std::llround(k.x2 * scale);
-            long long iy2 = std::llround(k.y2 * scale);
-            long long iz2 = std::llround(k.z2 * scale);
-            
-            // 组合哈希
-            std::size_t h1 = std::hash<long long>()(ix1);
-            std::size_t h2 = std::hash<long long>()(iy1);
-            std::size_t h3 = std::hash<long long>()(iz1);
-            std::size_t h4 = std::hash<long long>()(ix2);
-            std::size_t h5 = std::hash<long long>()(iy2);
-            std::size_t h6 = std::hash<long long>()(iz2);
-            
-            return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3) ^ (h5 << 4) ^ (h6 << 5);
+int find_root(std::vector<int32_t>& parent, int32_t i) {
+    while (parent[size_t(i)] != i) {
+        parent[size_t(i)] = parent[size_t(parent[size_t(i)])];
+        i = parent[size_t(i)];
+    }
+    return i;
+}
+
+// 顶点焊接：距离不超过tolerance的顶点归为同一个几何点（传递闭包），
+// 返回每个顶点所在几何点的代表顶点（组内最小下标）
+std::vector<int32_t> weld_vertices(const cfd::Mesh& mesh, double tolerance) {
+    const size_t n = mesh.num_vertices();
+    std::vector<int32_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    if (n == 0) {
+        return parent;
+    }
+
+    // 1. 按容差网格量化坐标
+    const cfd::AABB box = mesh.bounds();
+    const double cell = tolerance * kWeldCellScale;
+    const double max_cells = double(uint64_t(1) << kWeldAxisBits);
+    const cfd::Vector3d extent = box.extent();
+    if (extent.x / cell >= max_cells || extent.y / cell >= max_cells || extent.z / cell >= max_cells) {
+        throw std::runtime_error("Overlapping edge tolerance is too small for the model extent");
+    }
+    auto cell_of = [&](const cfd::Vector3d& p) {
+        return CellCoord{int64_t((p.x - box.min.x) / cell), int64_t((p.y - box.min.y) / cell),
+                         int64_t((p.z - box.min.z) / cell)};
+    };
+    const CellPacker packer(cell_of(box.max));
+    std::vector<uint64_t> hi(n), lo(n);
+    cfd::parallel_for(0, n, kGrain, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            packer.pack(cell_of(mesh.vertex(v)), hi[v], lo[v]);
+        }
+    });
+
+    // 2. 128位单元键并行排序，得到每个非空单元的顶点区间
+    const std::vector<int32_t> order = sort_order_128(hi, lo);
+    std::vector<uint64_t> cell_hi, cell_lo;
+    std::vector<int32_t> cell_start;
+    std::vector<int32_t> vertex_cell(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t v = size_t(order[i]);
+        if (i == 0 || hi[v] != cell_hi.back() || lo[v] != cell_lo.back()) {
+            cell_hi.push_back(hi[v]);
+            cell_lo.push_back(lo[v]);
+            cell_start.push_back(int32_t(i));
+        }
+        vertex_cell[v] = int32_t(cell_start.size() - 1);
+    }
+    cell_start.push_back(int32_t(n));
+    auto find_cell = [&](uint64_t key_hi, uint64_t key_lo) -> int64_t {
+        size_t first = 0, count = cell_hi.size();
+        while (count > 0) {
+            const size_t step = count / 2;
+            const size_t mid = first + step;
+            if (cell_hi[mid] < key_hi || (cell_hi[mid] == key_hi && cell_lo[mid] < key_lo)) {
+                first = mid + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
         }
+        return first < cell_hi.size() && cell_hi[first] == key_hi && cell_lo[first] == key_lo
+                   ? int64_t(first) : -1;
     };
+
+    // 3. 并行探测：只在顶点离单元某一侧不超过容差时检查该侧的相邻单元
+    const double tolerance_sq = tolerance * tolerance;
+    const size_t chunks = cfd::parallel_chunk_count(n, kGrain);
+    std::vector<std::vector<std::pair<int32_t, int32_t>>> close_pairs(chunks);
+    cfd::parallel_for_chunks(0, n, kGrain, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const cfd::Vector3d p = mesh.vertex(v);
+            const CellCoord c = cell_of(p);
+            const cfd::Vector3d offset(p.x - box.min.x - double(c.x) * cell,
+                                       p.y - box.min.y - double(c.y) * cell,
+                                       p.z - box.min.z - double(c.z) * cell);
+            auto range = [&](double o) {
+                return std::make_pair(o <= tolerance ? -1 : 0, cell - o <= tolerance ? 1 : 0);
+            };
+            const auto rx = range(offset.x), ry = range(offset.y), rz = range(offset.z);
+            for (int dx = rx.first; dx <= rx.second; ++dx) {
+                for (int dy = ry.first; dy <= ry.second; ++dy) {
+                    for (int dz = rz.first; dz <= rz.second; ++dz) {
+                        int64_t found = vertex_cell[v];  // 所在单元无需查找
+                        if (dx != 0 || dy != 0 || dz != 0) {
+                            const CellCoord probe{c.x + dx, c.y + dy, c.z + dz};
+                            if (probe.x < 0 || probe.y < 0 || probe.z < 0) continue;
+                            uint64_t key_hi, key_lo;
+                            packer.pack(probe, key_hi, key_lo);
+                            found = find_cell(key_hi, key_lo);
+                            if (found < 0) continue;
+                        }
+                        for (int32_t i = cell_start[size_t(found)]; i < cell_start[size_t(found) + 1]; ++i) {
+                            const int32_t u = order[size_t(i)];
+                            if (size_t(u) > v && (mesh.vertex(size_t(u)) - p).squared_norm() <= tolerance_sq) {
+                                close_pairs[chunk].emplace_back(int32_t(v), u);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // 4. 并查集合并，代表顶点取组内最小下标
+    for (const auto& pairs : close_pairs) {
+        for (const auto& pair : pairs) {
+            const int32_t a = find_root(parent, pair.first);
+            const int32_t b = find_root(parent, pair.second);
+            if (a != b) {
+                parent[size_t(std::max(a, b))] = std::min(a, b);
+            }
+        }
+    }
+    for (size_t v = 0; v < n; ++v) {
+        parent[v] = find_root(parent, int32_t(v));
+    }
+    return parent;
+}
+
+// 焊接后的一条几何边
+struct GeometricEdge {
+    int32_t a, b;          // 两个端点的代表顶点，a < b
+    int32_t first_a, first_b;  // 第一条使用该边的半边的原始顶点
+    int32_t uses;          // 使用该边的半边数
+};
+
+// 以P所在直线为基准：Q的两个端点到该直线的距离都不超过容差，且二者在
+// 直线上的投影区间重叠长度超过容差
+bool overlaps_along(const cfd::Vector3d& p0, const cfd::Vector3d& p1,
+                    const cfd::Vector3d& q0, const cfd::Vector3d& q1, double tolerance) {
+    const cfd::Vector3d d = p1 - p0;
+    const double length = d.norm();
+    if (length <= tolerance) {
+        return false;
+    }
+    const cfd::Vector3d u = d / length;
+    auto distance_to_line = [&](const cfd::Vector3d& q) {
+        const cfd::Vector3d w = q - p0;
+        return (w - u * w.dot(u)).norm();
+    };
+    if (distance_to_line(q0) > tolerance || distance_to_line(q1) > tolerance) {
+        return false;
+    }
+    double t0 = (q0 - p0).dot(u);
+    double t1 = (q1 - p0).dot(u);
+    if (t0 > t1) std::swap(t0, t1);
+    return std::min(length, t1) - std::max(0.0, t0) > tolerance;
+}
+
+// 判断两条线段是否共线并部分重叠。总以较长的边为基准直线：以短边为基准时，
+// 长边远端到短边延长线的距离会被放大，结果将取决于顶点和边的编号。
+// 例如容差1e-3时A=(0,0,0)、C=(3,0,0)、B=(1,0.6e-3,0)，以A-C为基准A-B在
+// 容差内，以A-B为基准C偏离1.2e-3。长度相等时任一方向通过即可
+bool collinear_overlap(const cfd::Vector3d& p0, const cfd::Vector3d& p1,
+                       const cfd::Vector3d& q0, const cfd::Vector3d& q1, double tolerance) {
+    const double p_length = (p1 - p0).squared_norm();
+    const double q_length = (q1 - q0).squared_norm();
+    if (p_length > q_length) {
+        return overlaps_along(p0, p1, q0, q1, tolerance);
+    }
+    if (q_length > p_length) {
+        return overlaps_along(q0, q1, p0, p1, tolerance);
+    }
+    return overlaps_along(p0, p1, q0, q1, tolerance) || overlaps_along(q0, q1, p0, p1, tolerance);
+}
+
+// 共线检测网格：按3D DDA（Amanatides-Woo）遍历线段经过的单元，
+// 单元坐标每轴kLineAxisBits位打包成一个64位键
+struct LineGrid {
+    const cfd::Mesh& mesh;
+    cfd::Vector3d origin;
+    double cell;
+
+    void cell_of(const cfd::Vector3d& p, int64_t c[3]) const {
+        c[0] = int64_t(std::floor((p.x - origin.x) / cell));
+        c[1] = int64_t(std::floor((p.y - origin.y) / cell));
+        c[2] = int64_t(std::floor((p.z - origin.z) / cell));
+    }
+
+    static uint64_t pack(const int64_t c[3]) {
+        return (uint64_t(c[0]) << (2 * kLineAxisBits)) | (uint64_t(c[1]) << kLineAxisBits) | uint64_t(c[2]);
+    }
+
+    // 按顺序对边经过的每个单元调用visit(单元键)
+    template <typename Visit>
+    void traverse(const GeometricEdge& e, Visit&& visit) const {
+        const cfd::Vector3d p0 = mesh.vertex(size_t(e.a)), p1 = mesh.vertex(size_t(e.b));
+        int64_t c[3], last[3];
+        cell_of(p0, c);
+        cell_of(p1, last);
+        const double start[3] = {p0.x - origin.x, p0.y - origin.y, p0.z - origin.z};
+        const double dir[3] = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+        int64_t step[3];
+        double t_max[3], t_delta[3];
+        int64_t steps = 0;
+        for (int k = 0; k < 3; ++k) {
+            step[k] = last[k] > c[k] ? 1 : (last[k] < c[k] ? -1 : 0);
+            steps += std::abs(last[k] - c[k]);
+            if (step[k] == 0) {
+                t_max[k] = t_delta[k] = std::numeric_limits<double>::infinity();
+            } else {
+                const double boundary = double(c[k] + (step[k] > 0 ? 1 : 0)) * cell;
+                t_max[k] = (boundary - start[k]) / dir[k];
+                t_delta[k] = cell / std::abs(dir[k]);
+            }
+        }
+        visit(pack(c));
+        for (int64_t s = 0; s < steps; ++s) {
+            const int k = t_max[0] <= t_max[1] ? (t_max[0] <= t_max[2] ? 0 : 2)
+                                               : (t_max[1] <= t_max[2] ? 1 : 2);
+            if (step[k] == 0) break;
+            c[k] += step[k];
+            t_max[k] += t_delta[k];
+            visit(pack(c));
+        }
+    }
+};
+
+} // namespace
+
+// 重叠边检测结果（下标均指向edges）
+struct OverlappingEdges {
+    std::vector<GeometricEdge> edges;                   // 焊接后的全部几何边
+    std::vector<int32_t> duplicates;                    // 被两个以上半边使用的几何边
+    std::vector<std::pair<int32_t, int32_t>> partial;   // 共线且部分重叠的几何边对
+};
+
+// 重叠边检测：
+// 1. 按容差焊接顶点（128位网格键并行排序，探测相邻单元）
+// 2. 焊接后的半边按(代表顶点, 代表顶点)打包为64位键并行基数排序分组，
+//    出现超过2次的几何边即为重复边
+// 3. 各几何边按3D DDA登记到经过的网格单元，(单元, 边)键排序后在每个单元内
+//    两两检测共线部分重叠
+OverlappingEdges find_overlapping_edges(const cfd::Mesh& mesh, double tolerance) {
+    if (!(tolerance > 0.0)) {
+        throw std::runtime_error("Overlapping edge tolerance must be positive");
+    }
+    const std::vector<int32_t> rep = weld_vertices(mesh, tolerance);
+    const size_t num_faces = mesh.num_faces();
+    const std::vector<int32_t>& faces = mesh.faces();
+
+    // 半边分组（端点焊接为同一点的退化半边跳过）。键为(a << index_bits) | b，
+    // 只占2 * index_bits位，基数排序的趟数更少
+    const unsigned index_bits = CellPacker::bit_width(uint64_t(mesh.num_vertices()));
+    const uint64_t low_mask = (uint64_t(1) << index_bits) - 1;
+    std::vector<uint64_t> keys(num_faces * 3);
+    std::vector<int32_t> half_edges(num_faces * 3);
+    cfd::parallel_for(0, num_faces, kGrain, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            for (size_t k = 0; k < 3; ++k) {
+                const size_t h = f * 3 + k;
+                const int32_t a = rep[size_t(faces[h])];
+                const int32_t b = rep[size_t(faces[f * 3 + (k + 1) % 3])];
+                keys[h] = a == b ? ~uint64_t(0)
+                                 : (uint64_t(std::min(a, b)) << index_bits) | uint64_t(std::max(a, b));
+                half_edges[h] = int32_t(h);
+            }
+        }
+    });
+    cfd::radix_sort_pairs(keys, half_edges);
+
+    OverlappingEdges result;
+    for (size_t i = 0; i < keys.size() && keys[i] != ~uint64_t(0);) {
+        size_t j = i + 1;
+        while (j < keys.size() && keys[j] == keys[i]) ++j;
+        const size_t h = size_t(half_edges[i]);
+        const int32_t a = faces[h];
+        const int32_t b = faces[h / 3 * 3 + (h % 3 + 1) % 3];
+        result.edges.push_back({int32_t(keys[i] >> index_bits), int32_t(keys[i] & low_mask),
+                                std::min(a, b), std::max(a, b), int32_t(j - i)});
+        if (j - i > 2) {
+            result.duplicates.push_back(int32_t(result.edges.size() - 1));
+        }
+        i = j;
+    }
+
+    // 共线检测网格：单元边长取几何边的平均长度，原点错开非整数个单元，
+    // 避免与坐标轴对齐的边恰好落在单元边界上
+    const size_t num_edges = result.edges.size();
+    if (num_edges < 2) {
+        return result;
+    }
+    auto endpoint = [&](const GeometricEdge& e, int k) { return mesh.vertex(size_t(k == 0 ? e.a : e.b)); };
+    double total_length = 0.0;
+    for (const GeometricEdge& e : result.edges) {
+        total_length += (endpoint(e, 1) - endpoint(e, 0)).norm();
+    }
+    const cfd::AABB box = mesh.bounds();
+    const cfd::Vector3d extent = box.extent();
+    const double max_cells = double((uint64_t(1) << kLineAxisBits) - 4);
+    double cell = std::max(total_length / double(num_edges), 4.0 * tolerance);
+    cell = std::max(cell, std::max(extent.x, std::max(extent.y, extent.z)) / max_cells);
+    const cfd::Vector3d origin = box.min - cfd::Vector3d(0.618034, 0.414214, 0.732051) * cell;
+    const LineGrid grid{mesh, origin, cell};
+
+    // (单元, 边)键：先统计每条边经过的单元数，前缀和后并行填充
+    std::vector<int64_t> first_slot(num_edges + 1, 0);
+    cfd::parallel_for(0, num_edges, kGrain, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            int64_t count = 0;
+            grid.traverse(result.edges[e], [&](uint64_t) { ++count; });
+            first_slot[e + 1] = count;
+        }
+    });
+    std::partial_sum(first_slot.begin(), first_slot.end(), first_slot.begin());
+    const size_t num_slots = size_t(first_slot[num_edges]);
+    std::vector<uint64_t> cell_keys(num_slots);
+    std::vector<int32_t> cell_edges(num_slots);
+    cfd::parallel_for(0, num_edges, kGrain, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            size_t slot = size_t(first_slot[e]);
+            grid.traverse(result.edges[e], [&](uint64_t key) {
+                cell_keys[slot] = key;
+                cell_edges[slot] = int32_t(e);
+                ++slot;
+            });
+        }
+    });
+    cfd::radix_sort_pairs(cell_keys, cell_edges);
+
+    std::vector<size_t> group_start;
+    for (size_t i = 0; i < cell_keys.size(); ++i) {
+        if (i == 0 || cell_keys[i] != cell_keys[i - 1]) group_start.push_back(i);
+    }
+    group_start.push_back(cell_keys.size());
+
+    // 各单元内两两检测，按单元区间并行；同一对边可能在多个单元中重复出现
+    const size_t num_groups = group_start.size() - 1;
+    const size_t group_grain = 1 << 10;
+    std::vector<std::vector<uint64_t>> found(cfd::parallel_chunk_count(num_groups, group_grain));
+    cfd::parallel_for_chunks(0, num_groups, group_grain, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t g = begin; g < end; ++g) {
+            for (size_t i = group_start[g]; i < group_start[g + 1]; ++i) {
+                const GeometricEdge& p = result.edges[size_t(cell_edges[i])];
+                for (size_t j = i + 1; j < group_start[g + 1]; ++j) {
+                    const GeometricEdge& q = result.edges[size_t(cell_edges[j])];
+                    if (collinear_overlap(endpoint(p, 0), endpoint(p, 1), endpoint(q, 0), endpoint(q, 1),
+                                          tolerance)) {
+                        found[chunk].push_back(cfd::edge_key(cell_edges[i], cell_edges[j]));
+                    }
+                }
+            }
+        }
+    });
+    std::vector<uint64_t> pair_keys;
+    for (const auto& keys_in_chunk : found) {
+        pair_keys.insert(pair_keys.end(), keys_in_chunk.begin(), keys_in_chunk.end());
+    }
+    std::vector<int32_t> unused(pair_keys.size(), 0);
+    cfd::radix_sort_pairs(pair_keys, unused);
+    pair_keys.erase(std::unique(pair_keys.begin(), pair_keys.end()), pair_keys.end());
+    for (uint64_t key : pair_keys) {
+        result.partial.emplace_back(cfd::edge_key_first(key), cfd::edge_key_second(key));
+    }
+    return result;
+}
+
+// 重叠边检测函数：重复边与共线部分重叠的边，按原始顶点下标(较小, 较大)升序返回
+std::vector<std::vector<int>> detect_overlapping_edges(const cfd::Mesh& mesh, double tolerance)
+{
+    const OverlappingEdges found = find_overlapping_edges(mesh, tolerance);
+    std::vector<int32_t> ids = found.duplicates;
+    for (const auto& pair : found.partial) {
+        ids.push_back(pair.first);
+        ids.push_back(pair.second);
+    }
+    std::sort(ids.begin(), ids.end(), [&](int32_t x, int32_t y) {
+        const GeometricEdge& a = found.edges[size_t(x)];
+        const GeometricEdge& b = found.edges[size_t(y)];
+        return std::make_pair(a.first_a, a.first_b) < std::make_pair(b.first_a, b.first_b);
+    });
+    std::vector<std::vector<int>> overlapping_edges;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const GeometricEdge& e = found.edges[size_t(ids[i])];
+        if (i > 0 && ids[i] == ids[i - 1]) continue;
+        overlapping_edges.push_back({e.first_a, e.first_b});
+    }
+    return overlapping_edges;
+}
+
+std::tuple<std::vector<std::vector<int>>, double> detect_overlapping_edges_mesh_with_timing(
+    const cfd::Mesh& mesh,
+    double tolerance = 1e-5)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<int>> overlapping_edges = detect_overlapping_edges(mesh, tolerance);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    return std::make_tuple(overlapping_edges, elapsed.count());
 }
 
-// 重叠边检测函数
 std::tuple<std::vector<std::vector<int>>, double> detect_overlapping_edges_with_timing(
-    py::array_t<double> vertices,
-    py::array_t<int> faces,
+    py::array vertices,
+    py::array faces,
     double tolerance = 1e-5)
 {
     auto start = std::chrono::high_resolution_clock::now();
-    
-    // 获取NumPy数组的缓冲区信息
-    auto vertices_buffer = vertices.request();
-    auto faces_buffer = faces.request();
-    
-    double* vertices_ptr = static_cast<double*>(vertices_buffer.ptr);
-    int* faces_ptr = static_cast<int*>(faces_buffer.ptr);
-    
-    int num_vertices = vertices_buffer.shape[0];
-    int num_faces = faces_buffer.shape[0];
-    
-    // 存储边的几何哈希与索引
-    std::unordered_map<EdgeKey, std::vector<std::pair<int, int>>> edge_map;
-    
-    // 遍历所有面片，收集边信息
-    for (int face_idx = 0; face_idx < num_faces; ++face_idx) {
-        int v1_idx = faces_ptr[face_idx * 3];
-        int v2_idx = faces_ptr[face_idx * 3 + 1];
-        int v3_idx = faces_ptr[face_idx * 3 + 2];
-        
-        // 获取面片的三条边
-        std::vector<std::pair<int, int>> edges = {
-            {v1_idx, v2_idx},
-            {v2_idx, v3_idx},
-            {v3_idx, v1_idx}
-        };
-        
-        for (const auto& edge : edges) {
-            int a = edge.first;
-            int b = edge.second;
-            
-            // 获取顶点坐标
-            double x1 = vertices_ptr[a * 3];
-            double y1 = vertices_ptr[a * 3 + 1];
-            double z1 = vertices_ptr[a * 3 + 2];
-            
-            double x2 = vertices_ptr[b * 3];
-            double y2 = vertices_ptr[b * 3 + 1];
-            double z2 = vertices_ptr[b * 3 + 2];
-            
-            // 创建边的几何键
-            EdgeKey key(x1, y1, z1, x2, y2, z2);
-            
-            // 存储边与其对应的顶点索引
-            edge_map[key].push_back({a, b});
-        }
-    }
-    
-    // 找出重叠边（出现超过2次的边）
+
+    const cfd::Mesh mesh = cfd::mesh_from_arrays(vertices, faces);
     std::vector<std::vector<int>> overlapping_edges;
-    for (const auto& pair : edge_map) {
-        if (pair.second.size() > 2) {
-            // 使用第一个找到的边作为代表
-            overlapping_edges.push_back({pair.second[0].first, pair.second[0].second});
-        }
+    {
+        py::gil_scoped_release release;
+        overlapping_edges = detect_overlapping_edges(mesh, tolerance);
     }
-    
+
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end - start;
-    
+
     return std::make_tuple(overlapping_edges, elapsed.count());
 }
 
+// 详细结果：重复边(k, 2)及其使用次数，共线部分重叠的边对(m, 4)
+py::dict overlapping_edge_details(const cfd::Mesh& mesh, double tolerance)
+{
+    OverlappingEdges found;
+    {
+        py::gil_scoped_release release;
+        found = find_overlapping_edges(mesh, tolerance);
+    }
+    py::array_t<int32_t> duplicates({py::ssize_t(found.duplicates.size()), py::ssize_t(2)});
+    py::array_t<int32_t> uses(py::ssize_t(found.duplicates.size()));
+    for (size_t i = 0; i < found.duplicates.size(); ++i) {
+        const GeometricEdge& e = found.edges[size_t(found.duplicates[i])];
+        duplicates.mutable_data()[i * 2] = e.first_a;
+        duplicates.mutable_data()[i * 2 + 1] = e.first_b;
+        uses.mutable_data()[i] = e.uses;
+    }
+    py::array_t<int32_t> partial({py::ssize_t(found.partial.size()), py::ssize_t(4)});
+    for (size_t i = 0; i < found.partial.size(); ++i) {
+        const GeometricEdge& p = found.edges[size_t(found.partial[i].first)];
+        const GeometricEdge& q = found.edges[size_t(found.partial[i].second)];
+        int32_t* row = partial.mutable_data() + i * 4;
+        row[0] = p.first_a; row[1] = p.first_b; row[2] = q.first_a; row[3] = q.first_b;
+    }
+    py::dict result;
+    result["duplicates"] = duplicates;
+    result["duplicate_uses"] = uses;
+    result["partial_overlaps"] = partial;
+    return result;
+}
+
+py::dict overlapping_edge_details_from_arrays(py::array vertices, py::array faces, double tolerance)
+{
+    return overlapping_edge_details(cfd::mesh_from_arrays(vertices, faces), tolerance);
+}
+
 // 创建Python模块
 PYBIND11_MODULE(overlapping_edges_cpp, m) {
     m.doc() = "C++ implementation of overlapping edges detection algorithm";
-    
+
+    // 传入mesh_reader_cpp.Mesh时直接使用共享的网格
+    // 合并结果：重复边和参与共线部分重叠的边放在同一个列表中，不区分类别；
+    // 需要区分时使用find_overlapping_edges
+    m.def("detect_overlapping_edges_with_timing", &detect_overlapping_edges_mesh_with_timing,
+          "Detect overlapping edges of a shared Mesh with timing information. The list merges "
+          "duplicate edges (used by more than two faces after welding) and every edge of a "
+          "collinear partially overlapping pair, as [a, b] vertex indices; use "
+          "find_overlapping_edges to tell them apart",
+          py::arg("mesh"), py::arg("tolerance") = 1e-5,
+          py::call_guard<py::gil_scoped_release>());
+
     m.def("detect_overlapping_edges_with_timing", &detect_overlapping_edges_with_timing,
-          "Detect overlapping edges with timing information",
+          "Detect overlapping edges with timing information. The list merges duplicate edges "
+          "(used by more than two faces after welding) and every edge of a collinear partially "
+          "overlapping pair, as [a, b] vertex indices; use find_overlapping_edges to tell them apart",
           py::arg("vertices"), py::arg("faces"), py::arg("tolerance") = 1e-5);
-} 
\ No newline at end of file
+
+    // 分类结果：重复边与共线部分重叠的边对
+    m.def("find_overlapping_edges", &overlapping_edge_details,
+          "Return duplicate edges with their use counts and collinear partially overlapping edge pairs",
+          py::arg("mesh"), py::arg("tolerance") = 1e-5);
+    m.def("find_overlapping_edges", &overlapping_edge_details_from_arrays,
+          "Return duplicate edges with their use counts and collinear partially overlapping edge pairs",
+          py::arg("vertices"), py::arg("faces"), py::arg("tolerance") = 1e-5);
+}
@@ -0,0 +1,85 @@
+#ifndef PARALLEL_UTILS_HPP
+#define PARALLEL_UTILS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace cfd {
+
+// Number of worker threads used when the caller passes 0.
+inline unsigned default_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Number of chunks parallel_for will split [0, count) into.
+inline size_t parallel_chunk_count(size_t count, size_t min_grain, unsigned num_threads = 0) {
+    if (num_threads == 0) {
+        num_threads = default_thread_count();
+    }
+    min_grain = std::max<size_t>(min_grain, 1);
+    size_t chunks = std::min<size_t>(num_threads, (count + min_grain - 1) / min_grain);
+    return std::max<size_t>(chunks, 1);
+}
+
+// Runs fn(chunk_index, chunk_begin, chunk_end) over contiguous chunks of [begin, end),
+// each holding at least min_grain items, one chunk per thread. The calling thread
+// processes the first chunk itself. The first exception thrown by any chunk is
+// rethrown once all threads have joined.
+template <typename Fn>
+void parallel_for_chunks(size_t begin, size_t end, size_t min_grain, Fn&& fn,
+                         unsigned num_threads = 0) {
+    if (end <= begin) {
+        return;
+    }
+    const size_t count = end - begin;
+    const size_t chunks = parallel_chunk_count(count, min_grain, num_threads);
+    if (chunks == 1) {
+        fn(size_t(0), begin, end);
+        return;
+    }
+
+    const size_t step = count / chunks;
+    const size_t remainder = count % chunks;
+    auto chunk_begin = [&](size_t c) { return begin + c * step + std::min(c, remainder); };
+
+    std::vector<std::exception_ptr> errors(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+        workers.emplace_back([&, c]() {
+            try {
+                fn(c, chunk_begin(c), chunk_begin(c + 1));
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+        });
+    }
+    try {
+        fn(size_t(0), chunk_begin(0), chunk_begin(1));
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Same as parallel_for_chunks for callers that do not need the chunk index.
+template <typename Fn>
+void parallel_for(size_t begin, size_t end, size_t min_grain, Fn&& fn, unsigned num_threads = 0) {
+    parallel_for_chunks(begin, end, min_grain,
+                        [&fn](size_t, size_t b, size_t e) { fn(b, e); }, num_threads);
+}
+
+} // namespace cfd
+
+#endif // PARALLEL_UTILS_HPP
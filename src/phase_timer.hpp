@@ -0,0 +1,31 @@
+#ifndef PHASE_TIMER_HPP
+#define PHASE_TIMER_HPP
+
+#include "mesh_reader.hpp"
+#include <chrono>
+
+namespace cfd {
+
+// Records the wall time of consecutive phases into LoadStats::phase_seconds.
+// Each lap() closes the phase that started at the previous lap (or at
+// construction) under the given name.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(LoadStats& stats) : stats_(stats), start_(Clock::now()) {}
+
+    void lap(const char* phase) {
+        const Clock::time_point now = Clock::now();
+        stats_.phase_seconds.emplace_back(phase, std::chrono::duration<double>(now - start_).count());
+        start_ = now;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    LoadStats& stats_;
+    Clock::time_point start_;
+};
+
+} // namespace cfd
+
+#endif // PHASE_TIMER_HPP
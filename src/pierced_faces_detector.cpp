@@ -11,6 +11,8 @@
 #include <limits>
 #include <functional>
 #include <tuple>
+#include "mesh_core.hpp"
+#include "mesh_core_py.hpp"
 
 namespace py = pybind11;
 using namespace std;
@@ -19,100 +21,16 @@ using namespace std;
 constexpr double EPSILON = 1e-10;
 constexpr double ALMOST_ZERO = 1e-8;
 
-// 定义三维向量类型
-struct Vector3d {
-    double x, y, z;
-    
-    Vector3d() : x(0), y(0), z(0) {}
-    Vector3d(double x, double y, double z) : x(x), y(y), z(z) {}
-    
-    Vector3d operator+(const Vector3d& other) const {
-        return Vector3d(x + other.x, y + other.y, z + other.z);
-    }
-    
-    Vector3d operator-(const Vector3d& other) const {
-        return Vector3d(x - other.x, y - other.y, z - other.z);
-    }
-    
-    Vector3d operator*(double scalar) const {
-        return Vector3d(x * scalar, y * scalar, z * scalar);
-    }
-    
-    Vector3d operator/(double scalar) const {
-        if (std::abs(scalar) < ALMOST_ZERO) {
-            return Vector3d();
-        }
-        return Vector3d(x / scalar, y / scalar, z / scalar);
-    }
-    
-    double dot(const Vector3d& other) const {
-        return x * other.x + y * other.y + z * other.z;
-    }
-    
-    Vector3d cross(const Vector3d& other) const {
-        return Vector3d(
-            y * other.z - z * other.y,
-            z * other.x - x * other.z,
-            x * other.y - y * other.x
-        );
-    }
-    
-    double norm() const {
-        return std::sqrt(x * x + y * y + z * z);
-    }
-    
-    Vector3d normalized() const {
-        double length = norm();
-        if (length < ALMOST_ZERO) {
-            return Vector3d();
-        }
-        return *this / length;
-    }
-    
-    bool isZero(double eps = ALMOST_ZERO) const {
-        return std::abs(x) < eps && std::abs(y) < eps && std::abs(z) < eps;
-    }
-    
-    static Vector3d Zero() {
-        return Vector3d();
-    }
-};
-
-// 三角形结构
-struct Triangle {
-    array<Vector3d, 3> vertices;
-
-    Triangle(const Vector3d& v0, const Vector3d& v1, const Vector3d& v2) {
-        vertices = {v0, v1, v2};
-    }
-};
-
-// AABB包围盒
-struct AABB {
-    Vector3d min;
-    Vector3d max;
-
-    AABB(const Vector3d& min_point, const Vector3d& max_point) 
-        : min(min_point), max(max_point) {}
-
-    bool intersects(const AABB& other) const {
-        return (min.x <= other.max.x && max.x >= other.min.x &&
-                min.y <= other.max.y && max.y >= other.min.y &&
-                min.z <= other.max.z && max.z >= other.min.z);
-    }
-};
+using cfd::AABB;
+using cfd::Triangle;
+using cfd::Vector3d;
 
 // 获取三角形的法向量
 Vector3d get_normal(const Triangle& tri) {
     Vector3d v1 = tri.vertices[1] - tri.vertices[0];
     Vector3d v2 = tri.vertices[2] - tri.vertices[0];
     Vector3d normal = v1.cross(v2);
-    double norm = normal.norm();
-    
-    if (norm < ALMOST_ZERO) {
-        return Vector3d::Zero();
-    }
-    return normal / norm;
+    return cfd::divide_or_zero(normal, normal.norm(), ALMOST_ZERO);
 }
 
 // 获取三角形的边
@@ -178,7 +96,7 @@ bool check_triangle_intersection(const Triangle& tri1, const Triangle& tri2) {
         for (const auto& e2 : edges2) {
             Vector3d cross = e1.cross(e2);
             if (!cross.isZero()) {
-                Vector3d axis = cross.normalized();
+                Vector3d axis = cfd::divide_or_zero(cross, cross.norm(), ALMOST_ZERO);
                 if (check_separation(tri1, tri2, axis)) {
                     return false;
                 }
@@ -190,24 +108,6 @@ bool check_triangle_intersection(const Triangle& tri1, const Triangle& tri2) {
     return true;
 }
 
-// 计算三角形的AABB包围盒
-AABB compute_triangle_aabb(const Triangle& tri) {
-    Vector3d min_point = tri.vertices[0];
-    Vector3d max_point = tri.vertices[0];
-    
-    for (int i = 1; i < 3; ++i) {
-        min_point.x = min(min_point.x, tri.vertices[i].x);
-        min_point.y = min(min_point.y, tri.vertices[i].y);
-        min_point.z = min(min_point.z, tri.vertices[i].z);
-        
-        max_point.x = max(max_point.x, tri.vertices[i].x);
-        max_point.y = max(max_point.y, tri.vertices[i].y);
-        max_point.z = max(max_point.z, tri.vertices[i].z);
-    }
-    
-    return AABB(min_point, max_point);
-}
-
 // 八叉树节点
 struct OctreeNode {
     Vector3d center;
@@ -281,81 +181,24 @@ shared_ptr<OctreeNode> build_octree(const vector<Triangle>& triangles,
 }
 
 // 主函数：检测相交的面片
-std::tuple<std::vector<int>, std::map<int, std::vector<int>>, double> detect_pierced_faces_with_timing(py::array_t<int> py_faces, py::array_t<double> py_vertices) {
+std::tuple<std::vector<int>, std::map<int, std::vector<int>>, double> detect_pierced_faces_mesh_with_timing(const cfd::Mesh& mesh) {
     auto start = std::chrono::high_resolution_clock::now();
     
-    // 转换输入数据
-    auto faces_buf = py_faces.unchecked<2>();
-    auto vertices_buf = py_vertices.unchecked<2>();
-    
-    const size_t num_faces = faces_buf.shape(0);
-    const size_t num_vertices = vertices_buf.shape(0);
+    const size_t num_faces = mesh.num_faces();
     
-    // 创建三角形数组
+    // 创建三角形数组；AABB包围盒取自Mesh的缓存
     vector<Triangle> triangles;
     triangles.reserve(num_faces);
-    
-    // 创建AABB数组
-    vector<AABB> face_bboxes;
-    face_bboxes.reserve(num_faces);
-    
-    // 填充数据
     for (size_t face_idx = 0; face_idx < num_faces; ++face_idx) {
-        Vector3d v0(
-            vertices_buf(faces_buf(face_idx, 0), 0),
-            vertices_buf(faces_buf(face_idx, 0), 1),
-            vertices_buf(faces_buf(face_idx, 0), 2)
-        );
-        
-        Vector3d v1(
-            vertices_buf(faces_buf(face_idx, 1), 0),
-            vertices_buf(faces_buf(face_idx, 1), 1),
-            vertices_buf(faces_buf(face_idx, 1), 2)
-        );
-        
-        Vector3d v2(
-            vertices_buf(faces_buf(face_idx, 2), 0),
-            vertices_buf(faces_buf(face_idx, 2), 1),
-            vertices_buf(faces_buf(face_idx, 2), 2)
-        );
-        
-        Triangle tri(v0, v1, v2);
-        triangles.push_back(tri);
-        
-        // 计算AABB包围盒
-        face_bboxes.push_back(compute_triangle_aabb(tri));
+        triangles.push_back(mesh.triangle(face_idx));
     }
+    const vector<AABB>& face_bboxes = mesh.face_boxes();
     
     // 计算八叉树的边界
-    Vector3d min_point(
-        std::numeric_limits<double>::max(),
-        std::numeric_limits<double>::max(),
-        std::numeric_limits<double>::max()
-    );
-    Vector3d max_point(
-        std::numeric_limits<double>::lowest(),
-        std::numeric_limits<double>::lowest(),
-        std::numeric_limits<double>::lowest()
-    );
-    
-    for (const auto& tri : triangles) {
-        for (const auto& v : tri.vertices) {
-            min_point.x = std::min(min_point.x, v.x);
-            min_point.y = std::min(min_point.y, v.y);
-            min_point.z = std::min(min_point.z, v.z);
-            
-            max_point.x = std::max(max_point.x, v.x);
-            max_point.y = std::max(max_point.y, v.y);
-            max_point.z = std::max(max_point.z, v.z);
-        }
-    }
-    
-    Vector3d center(
-        (min_point.x + max_point.x) / 2.0,
-        (min_point.y + max_point.y) / 2.0,
-        (min_point.z + max_point.z) / 2.0
-    );
-    double size = std::max(std::max(max_point.x - min_point.x, max_point.y - min_point.y), max_point.z - min_point.z) * 1.01; // 稍微扩大一点
+    const AABB bounds = mesh.bounds();
+    Vector3d center = bounds.center();
+    const Vector3d extent = bounds.extent();
+    double size = std::max(std::max(extent.x, extent.y), extent.z) * 1.01; // 稍微扩大一点
     
     // 构建八叉树
     vector<int> all_indices(num_faces);
@@ -491,8 +334,23 @@ std::tuple<std::vector<int>, std::map<int, std::vector<int>>, double> detect_pie
     return std::make_tuple(result, result_map, elapsed.count());
 }
 
+std::tuple<std::vector<int>, std::map<int, std::vector<int>>, double> detect_pierced_faces_with_timing(py::array py_faces, py::array py_vertices) {
+    // 转换输入数据
+    const cfd::Mesh mesh = cfd::mesh_from_arrays(py_vertices, py_faces);
+    py::gil_scoped_release release;
+    return detect_pierced_faces_mesh_with_timing(mesh);
+}
+
 PYBIND11_MODULE(pierced_faces_cpp, m) {
     m.doc() = "C++ implementation of pierced faces detection";
+    // 传入mesh_reader_cpp.Mesh时复用其缓存的面片包围盒
+    m.def(
+        "detect_pierced_faces_with_timing",
+        &detect_pierced_faces_mesh_with_timing,
+        "Detect pierced faces of a shared Mesh and return intersection indices and map with timing",
+        py::arg("mesh"),
+        py::call_guard<py::gil_scoped_release>()
+    );
     m.def(
         "detect_pierced_faces_with_timing", 
         &detect_pierced_faces_with_timing, 
@@ -54,7 +54,7 @@ class BuildExt(build_ext):
 # 定义C++扩展模块
 free_edges_module = Extension(
     'free_edges_cpp',
-    sources=['free_edges_detector.cpp'],
+    sources=['free_edges_detector.cpp', 'mesh_core.cpp'],
     include_dirs=[
         get_pybind_include(),
         get_pybind_include(user=True)
@@ -57,7 +57,7 @@ class BuildExt(build_ext):
 # 定义C++扩展模块
 face_quality_module = Extension(
     'face_quality_cpp',
-    sources=['face_quality_detector.cpp'],
+    sources=['face_quality_detector.cpp', 'mesh_core.cpp', 'face_quality.cpp'],
     include_dirs=[
         get_pybind_include(),
         get_pybind_include(user=True)
@@ -9,8 +9,9 @@ setup_dir = os.path.dirname(os.path.abspath(__file__))
 ext_modules = [
     Extension(
         "non_manifold_vertices_cpp",
-        [os.path.join(setup_dir, "non_manifold_vertices_detector.cpp")],
-        include_dirs=[pybind11.get_include()],
+        [os.path.join(setup_dir, "non_manifold_vertices_detector.cpp"),
+         os.path.join(setup_dir, "mesh_core.cpp")],
+        include_dirs=[pybind11.get_include(), setup_dir],
         language="c++",
     ),
 ]
@@ -20,7 +20,7 @@ class get_pybind_include(object):
 ext_modules = [
     Extension(
         'overlapping_edges_cpp',
-        ['overlapping_edges_detector.cpp'],
+        ['overlapping_edges_detector.cpp', 'mesh_core.cpp'],
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True)
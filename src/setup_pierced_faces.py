@@ -24,7 +24,7 @@ class get_pybind_include(object):
 ext_modules = [
     Extension(
         'pierced_faces_cpp',
-        ['pierced_faces_detector.cpp'],
+        ['pierced_faces_detector.cpp', 'mesh_core.cpp'],
         include_dirs=[
             # Path to pybind11 headers
             get_pybind_include(),
@@ -0,0 +1,137 @@
+#ifndef TEXT_PARSE_HPP
+#define TEXT_PARSE_HPP
+
+#include <cstdint>
+
+// Allocation-free number parsing over raw character ranges, used by the
+// text format readers instead of std::istringstream.
+
+namespace cfd {
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Narrows [begin, end) by dropping leading and trailing blanks.
+inline void trim_blanks(const char*& begin, const char*& end) {
+    while (begin < end && is_blank(*begin)) ++begin;
+    while (end > begin && is_blank(end[-1])) --end;
+}
+
+// Parses an optionally signed decimal integer filling the whole (trimmed) range.
+inline bool parse_int(const char* begin, const char* end, int& value) {
+    trim_blanks(begin, end);
+    if (begin == end) return false;
+
+    bool negative = false;
+    if (*begin == '+' || *begin == '-') {
+        negative = (*begin == '-');
+        ++begin;
+    }
+    if (begin == end) return false;
+
+    int64_t result = 0;
+    for (; begin < end; ++begin) {
+        if (!is_digit(*begin)) return false;
+        result = result * 10 + (*begin - '0');
+        if (result > INT32_MAX) return false;
+    }
+    value = int(negative ? -result : result);
+    return true;
+}
+
+// Parses a real number filling the whole (trimmed) range. Besides the usual
+// forms ("1", "-2.5", "1.0e-3") this accepts the NASTRAN variants "1.0D-3"
+// and the implicit-exponent notation "1.0-3" / "2.5+2".
+inline bool parse_real(const char* begin, const char* end, double& value) {
+    static const double kPow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    trim_blanks(begin, end);
+    if (begin == end) return false;
+
+    bool negative = false;
+    if (*begin == '+' || *begin == '-') {
+        negative = (*begin == '-');
+        ++begin;
+    }
+
+    // Mantissa digits are accumulated into an integer; digits beyond the
+    // 19th only shift the decimal exponent.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+
+    for (; begin < end && is_digit(*begin); ++begin) {
+        any_digit = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + uint64_t(*begin - '0');
+            if (mantissa != 0) ++digits;
+        } else {
+            ++exponent;
+        }
+    }
+    if (begin < end && *begin == '.') {
+        ++begin;
+        for (; begin < end && is_digit(*begin); ++begin) {
+            any_digit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + uint64_t(*begin - '0');
+                if (mantissa != 0) ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!any_digit) return false;
+
+    if (begin < end) {
+        char c = *begin;
+        if (c == 'e' || c == 'E' || c == 'd' || c == 'D') {
+            ++begin;
+            if (begin == end) return false;
+            c = *begin;
+        }
+        if (c != '+' && c != '-' && !is_digit(c)) return false;
+
+        bool negative_exp = false;
+        if (c == '+' || c == '-') {
+            negative_exp = (c == '-');
+            ++begin;
+        }
+        if (begin == end) return false;
+
+        int exp_value = 0;
+        for (; begin < end; ++begin) {
+            if (!is_digit(*begin)) return false;
+            if (exp_value < 10000) exp_value = exp_value * 10 + (*begin - '0');
+        }
+        exponent += negative_exp ? -exp_value : exp_value;
+    }
+
+    double result = double(mantissa);
+    if (mantissa != 0) {
+        int e = exponent;
+        while (e > 22) { result *= 1e22; e -= 22; }
+        while (e < -22) { result /= 1e22; e += 22; }
+        result = e >= 0 ? result * kPow10[e] : result / kPow10[-e];
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+inline bool parse_real(const char* begin, const char* end, float& value) {
+    double result;
+    if (!parse_real(begin, end, result)) return false;
+    value = float(result);
+    return true;
+}
+
+} // namespace cfd
+
+#endif // TEXT_PARSE_HPP
@@ -0,0 +1,247 @@
+import math
+
+import pytest
+import numpy as np
+
+face_quality_cpp = pytest.importorskip("face_quality_cpp")
+
+TRIANGLE_FIELDS = ("quality", "aspect_ratio", "skewness", "min_angle", "max_angle", "area",
+                   "edge_ratio")
+QUAD_FIELDS = ("aspect_ratio", "skewness", "min_angle", "max_angle", "area", "edge_ratio",
+               "warpage")
+
+
+def _record(records, index):
+    return {name: float(records[name][index]) for name in records.dtype.names}
+
+
+def test_face_metrics_known_triangles():
+    h = math.sqrt(3.0) / 2
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0.5, h, 0],  # equilateral
+                         [3, 0, 0], [0, 4, 0],               # 3-4-5 right triangle on vertex 0
+                         [2, 0, 0]], dtype=np.float64)       # collinear with vertices 0, 1
+    faces = np.array([[0, 1, 2], [0, 3, 4], [0, 1, 5]], dtype=np.int32)
+    records = face_quality_cpp.compute_face_metrics(vertices, faces)
+    assert records.dtype.names == TRIANGLE_FIELDS
+    assert len(records) == 3
+
+    equilateral = _record(records, 0)
+    assert equilateral["quality"] == pytest.approx(1.0, rel=1e-5)
+    assert equilateral["aspect_ratio"] == pytest.approx(1.0, rel=1e-5)
+    assert equilateral["skewness"] == pytest.approx(0.0, abs=1e-5)
+    assert equilateral["min_angle"] == pytest.approx(60.0, rel=1e-5)
+    assert equilateral["max_angle"] == pytest.approx(60.0, rel=1e-5)
+    assert equilateral["area"] == pytest.approx(math.sqrt(3.0) / 4, rel=1e-5)
+    assert equilateral["edge_ratio"] == pytest.approx(1.0, rel=1e-5)
+
+    # r = 1 and R = 2.5; the smallest angle atan(3/4) sets the skewness
+    right = _record(records, 1)
+    smallest = math.degrees(math.atan2(3.0, 4.0))
+    assert right["quality"] == pytest.approx(0.8, rel=1e-5)
+    assert right["aspect_ratio"] == pytest.approx(5.0 * 12.0 / (4.0 * math.sqrt(3.0) * 6.0), rel=1e-5)
+    assert right["skewness"] == pytest.approx((60.0 - smallest) / 60.0, rel=1e-5)
+    assert right["min_angle"] == pytest.approx(smallest, rel=1e-5)
+    assert right["max_angle"] == pytest.approx(90.0, rel=1e-5)
+    assert right["area"] == pytest.approx(6.0, rel=1e-5)
+    assert right["edge_ratio"] == pytest.approx(5.0 / 3.0, rel=1e-5)
+
+    # Zero area but no zero edge: the edge ratio stays finite
+    degenerate = _record(records, 2)
+    assert degenerate["quality"] == 0.0
+    assert degenerate["aspect_ratio"] == math.inf
+    assert degenerate["skewness"] == 1.0
+    assert degenerate["min_angle"] == 0.0
+    assert degenerate["max_angle"] == 180.0
+    assert degenerate["area"] == 0.0
+    assert degenerate["edge_ratio"] == pytest.approx(2.0, rel=1e-5)
+
+
+def test_quad_metrics_known_quads():
+    vertices = np.array([[0, 0, 0], [2, 1, 0], [0, 2, 0], [0.5, 1, 0],  # dart, reflex at vertex 3
+                         [1, 0, 0], [1, 1, 1], [0, 1, 0]],             # warped unit square on vertex 0
+                        dtype=np.float64)
+    quads = np.array([[0, 1, 2, 3], [0, 4, 5, 6]], dtype=np.int32)
+    records = face_quality_cpp.compute_quad_metrics(vertices, quads)
+    assert records.dtype.names == QUAD_FIELDS
+
+    concave = _record(records, 0)
+    reflex = 360.0 - math.degrees(math.acos(-0.6))
+    assert concave["max_angle"] == pytest.approx(reflex, rel=1e-5)
+    assert concave["max_angle"] > 180.0
+    assert concave["min_angle"] == pytest.approx(math.degrees(math.acos(0.8)), rel=1e-5)
+    assert concave["skewness"] == 1.0
+    assert concave["area"] == pytest.approx(1.5, rel=1e-5)
+    assert concave["edge_ratio"] == pytest.approx(2.0, rel=1e-5)
+    assert concave["aspect_ratio"] == pytest.approx(2.5, rel=1e-5)
+    assert concave["warpage"] == 0.0
+
+    # Both diagonal splits give triangle normals 60 degrees apart; the area
+    # is that of the vector area, half the diagonals' cross product
+    warped = _record(records, 1)
+    assert warped["warpage"] == pytest.approx(60.0, rel=1e-5)
+    assert warped["area"] == pytest.approx(math.sqrt(6.0) / 2, rel=1e-5)
+    assert warped["edge_ratio"] == pytest.approx(math.sqrt(2.0), rel=1e-5)
+    assert warped["max_angle"] == pytest.approx(90.0, rel=1e-5)
+
+
+def test_metric_subset_record_layout():
+    vertices = np.array([[0, 0, 0], [3, 0, 0], [0, 4, 0]], dtype=np.float64)
+    faces = np.array([[0, 1, 2]], dtype=np.int32)
+    # Fields follow the metric bit order, not the requested order
+    records = face_quality_cpp.compute_face_metrics(vertices, faces, ["max_angle", "skewness", "area"])
+    assert records.dtype.names == ("skewness", "max_angle", "area")
+    assert records.dtype.itemsize == 3 * 4
+    for name in records.dtype.names:
+        assert records.dtype.fields[name][0] == np.dtype("<f4")
+    assert [records.dtype.fields[name][1] for name in records.dtype.names] == [0, 4, 8]
+    assert float(records["area"][0]) == pytest.approx(6.0, rel=1e-5)
+
+    quads = np.array([[0, 1, 2, 2]], dtype=np.int32)
+    records = face_quality_cpp.compute_quad_metrics(vertices, quads, ["warpage", "min_angle"])
+    assert records.dtype.names == ("min_angle", "warpage")
+
+
+def test_metric_names_are_validated():
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0]], dtype=np.float64)
+    faces = np.array([[0, 1, 2]], dtype=np.int32)
+    with pytest.raises(RuntimeError, match="Unknown quality metric"):
+        face_quality_cpp.compute_face_metrics(vertices, faces, ["area", "jacobian"])
+    with pytest.raises(RuntimeError):
+        face_quality_cpp.compute_face_metrics(vertices, faces, [])
+    with pytest.raises(RuntimeError, match="Unknown quality metric"):
+        face_quality_cpp.compute_quad_metrics(vertices, np.array([[0, 1, 2, 2]], dtype=np.int32),
+                                              ["Area"])
+    with pytest.raises(RuntimeError):
+        face_quality_cpp.compute_quad_metrics(vertices, faces)
+
+
+def test_statistics_non_finite_and_out_of_range_values():
+    values = np.array([0.25, np.nan, 0.75, np.inf, -np.inf, -5.0, 7.0, np.nan, 0.5], dtype=np.float32)
+    stats = face_quality_cpp.quality_statistics(values, bins=4, range=(0.0, 1.0), threshold=0.3)
+
+    # NaN is skipped; +-inf, -5 and 7 fall into the end bins
+    assert stats["count"] == 7
+    assert stats["counts"].tolist() == [2, 1, 1, 3]
+    assert stats["edges"].tolist() == [0.0, 0.25, 0.5, 0.75, 1.0]
+    assert stats["min"] == -math.inf
+    assert stats["max"] == math.inf
+
+    # Moments over the finite values only
+    finite = np.array([0.25, 0.75, -5.0, 7.0, 0.5])
+    assert stats["mean"] == pytest.approx(finite.mean())
+    assert stats["variance"] == pytest.approx(finite.var())
+    assert stats["std"] == pytest.approx(finite.std())
+
+    assert stats["below"].tolist() == [0, 4, 5]
+
+
+def test_statistics_below_is_ordered_across_chunks():
+    # Several times the per-thread chunk of 65536 values
+    rng = np.random.default_rng(7)
+    values = rng.random(3 * 65536 + 123, dtype=np.float32)
+    stats = face_quality_cpp.quality_statistics(values, bins=50, threshold=0.2)
+    assert stats["count"] == len(values)
+    assert int(stats["counts"].sum()) == len(values)
+    assert stats["below"].tolist() == np.flatnonzero(values.astype(np.float64) < 0.2).tolist()
+    assert stats["mean"] == pytest.approx(float(values.astype(np.float64).mean()), rel=1e-9)
+    assert stats["variance"] == pytest.approx(float(values.astype(np.float64).var()), rel=1e-6)
+    assert stats["min"] == float(values.min())
+    assert stats["max"] == float(values.max())
+
+
+def test_statistics_bins_against_double_edges():
+    # float32 0.7 and 0.9 sit just below the double edges
+    values = np.array([0.7, 0.9], dtype=np.float32)
+    stats = face_quality_cpp.quality_statistics(values)
+    assert np.flatnonzero(stats["counts"]).tolist() == [6, 8]
+
+
+@pytest.mark.parametrize("bins, value_range", [(0, (0.0, 1.0)), (10, (1.0, 1.0)), (10, (1.0, 0.0))])
+def test_statistics_rejects_empty_bins_or_range(bins, value_range):
+    values = np.array([0.5], dtype=np.float32)
+    with pytest.raises(RuntimeError):
+        face_quality_cpp.quality_statistics(values, bins=bins, range=value_range)
+
+
+def _grid(n):
+    # n x n vertices in the z = 0 plane, two triangles per cell
+    i, j = np.meshgrid(np.arange(n), np.arange(n))
+    vertices = np.stack([i.ravel(), j.ravel(), np.zeros(n * n)], axis=1).astype(np.float64)
+    a = (np.arange(n - 1)[None, :] + n * np.arange(n - 1)[:, None]).ravel()
+    faces = np.concatenate([np.stack([a, a + 1, a + n + 1], axis=1),
+                            np.stack([a, a + n + 1, a + n], axis=1)]).astype(np.int32)
+    return vertices, faces
+
+
+def _assert_same_tracker_state(tracker, fresh):
+    assert tracker.num_faces == fresh.num_faces
+    assert np.array_equal(tracker.quality, fresh.quality)
+    assert tracker.counts.tolist() == fresh.counts.tolist()
+    assert tracker.low_count == fresh.low_count
+    assert tracker.low_faces().tolist() == fresh.low_faces().tolist()
+
+    stats, expected = tracker.statistics(), fresh.statistics()
+    assert stats["count"] == expected["count"]
+    assert stats["counts"].tolist() == expected["counts"].tolist()
+    assert stats["min"] == expected["min"]
+    assert stats["max"] == expected["max"]
+    assert stats["mean"] == pytest.approx(expected["mean"], rel=1e-9)
+    assert stats["variance"] == pytest.approx(expected["variance"], rel=1e-6, abs=1e-12)
+    assert stats["percentile_values"] == pytest.approx(expected["percentile_values"], rel=1e-9)
+    assert len(stats["below"]) == 0
+
+
+def test_quality_tracker_update_matches_fresh_tracker():
+    vertices, faces = _grid(40)
+    tracker = face_quality_cpp.QualityTracker(vertices, faces, threshold=0.5)
+    before = set(tracker.low_faces().tolist())
+    assert tracker.num_faces == len(faces)
+
+    rng = np.random.default_rng(3)
+    for _ in range(3):
+        moved = rng.choice(len(vertices), size=60, replace=False).astype(np.int32)
+        vertices[moved] += rng.uniform(-0.9, 0.9, size=(len(moved), 3))
+
+        change = tracker.update(vertices, faces, vertex_ids=moved)
+        around = np.flatnonzero(np.isin(faces, moved).any(axis=1))
+        assert change["updated"].tolist() == around.tolist()
+
+        fresh = face_quality_cpp.QualityTracker(vertices, faces, threshold=0.5)
+        _assert_same_tracker_state(tracker, fresh)
+
+        after = set(fresh.low_faces().tolist())
+        assert change["added"].tolist() == sorted(after - before)
+        assert change["removed"].tolist() == sorted(before - after)
+        before = after
+
+
+def test_quality_tracker_update_by_face_ids():
+    vertices, faces = _grid(12)
+    tracker = face_quality_cpp.QualityTracker(vertices, faces)
+    vertices[[5, 30]] += [[0.4, 0.7, 0.3], [-0.8, 0.1, 2.0]]
+    edited = np.flatnonzero(np.isin(faces, [5, 30]).any(axis=1)).astype(np.int32)
+
+    change = tracker.update(vertices, faces, face_ids=edited)
+    assert change["updated"].tolist() == edited.tolist()
+    _assert_same_tracker_state(tracker, face_quality_cpp.QualityTracker(vertices, faces))
+
+    # Without ids every face is recomputed
+    vertices[77] += [0.3, -0.6, 0.5]
+    change = tracker.update(vertices, faces)
+    assert change["updated"].tolist() == list(range(len(faces)))
+    _assert_same_tracker_state(tracker, face_quality_cpp.QualityTracker(vertices, faces))
+
+
+def test_quality_tracker_rejects_changed_face_count():
+    vertices, faces = _grid(6)
+    tracker = face_quality_cpp.QualityTracker(vertices, faces)
+    with pytest.raises(RuntimeError):
+        tracker.update(vertices, faces[:-1], face_ids=np.array([0], dtype=np.int32))
+    extra = np.concatenate([faces, [[0, 1, 7]]]).astype(np.int32)
+    with pytest.raises(RuntimeError):
+        tracker.update(vertices, extra, vertex_ids=np.array([0], dtype=np.int32))
+
+    # A reset accepts the new connectivity
+    tracker.reset(vertices, extra)
+    assert tracker.num_faces == len(extra)
+    _assert_same_tracker_state(tracker, face_quality_cpp.QualityTracker(vertices, extra))
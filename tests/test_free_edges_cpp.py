@@ -0,0 +1,66 @@
+import pytest
+import numpy as np
+
+free_edges_cpp = pytest.importorskip("free_edges_cpp")
+
+# Two triangles sharing the edge (1, 2), and two more fanned onto (0, 1) so
+# that edge is used by three faces
+FACES = [[0, 1, 2], [1, 3, 2], [0, 1, 4], [1, 0, 5]]
+FREE_EDGES = [[0, 2], [0, 4], [0, 5], [1, 3], [1, 4], [1, 5], [2, 3]]
+
+
+def test_free_edges_array_return():
+    edges = free_edges_cpp.detect_free_edges(np.array(FACES, dtype=np.int32))
+    assert edges.dtype == np.int32
+    assert edges.shape == (len(FREE_EDGES), 2)
+    assert edges.tolist() == FREE_EDGES
+
+    timed, seconds = free_edges_cpp.detect_free_edges_with_timing(np.array(FACES, dtype=np.int32))
+    assert timed.tolist() == FREE_EDGES
+    assert seconds >= 0.0
+
+
+def test_free_edges_array_input_layouts():
+    int64_faces = np.array(FACES, dtype=np.int64)
+    fortran_faces = np.asfortranarray(np.array(FACES, dtype=np.int32))
+    padded = np.zeros((len(FACES), 6), dtype=np.int32)
+    padded[:, ::2] = FACES
+    strided_faces = padded[:, ::2]
+    assert not strided_faces.flags["C_CONTIGUOUS"]
+
+    for faces in (int64_faces, fortran_faces, strided_faces):
+        assert free_edges_cpp.detect_free_edges(faces).tolist() == FREE_EDGES
+        assert free_edges_cpp.detect_non_manifold_edges(faces).tolist() == [[0, 1]]
+
+
+def test_free_edges_array_matches_list_overload():
+    as_lists = free_edges_cpp.detect_free_edges(FACES)
+    as_array = free_edges_cpp.detect_free_edges(np.array(FACES))
+    assert [list(edge) for edge in as_lists] == as_array.tolist()
+
+    non_manifold = free_edges_cpp.detect_non_manifold_edges(FACES)
+    assert [list(edge) for edge in non_manifold] == [[0, 1]]
+
+
+def test_free_edges_array_rejects_invalid_indices():
+    with pytest.raises(RuntimeError):
+        free_edges_cpp.detect_free_edges(np.array([[0, 1, -1]], dtype=np.int32))
+    # Would wrap to the valid index 1 if narrowed to int32 first
+    with pytest.raises(RuntimeError):
+        free_edges_cpp.detect_free_edges(np.array([[0, 2**32 + 1, 2]], dtype=np.int64))
+    with pytest.raises(RuntimeError):
+        free_edges_cpp.detect_free_edges(np.array([[0, 1]], dtype=np.int32))
+
+
+def test_free_edges_list_rejects_negative_indices():
+    # Sign-extended into the edge keys, -1 would pair with itself and hide
+    # the free edges of both faces
+    faces = [[-1, -2, 0], [-1, -3, 0]]
+    with pytest.raises(RuntimeError, match="Face 0"):
+        free_edges_cpp.detect_free_edges(faces)
+    with pytest.raises(RuntimeError):
+        free_edges_cpp.detect_free_edges_with_timing(faces)
+    with pytest.raises(RuntimeError, match="Face 1"):
+        free_edges_cpp.detect_non_manifold_edges([[0, 1, 2], [1, 2, -4]])
+    with pytest.raises(RuntimeError):
+        free_edges_cpp.edge_face_incidence(faces)
@@ -1,6 +1,6 @@
 import pytest
 import numpy as np
-from mesh_reader_cpp import create_mesh_reader, STLReader, NASReader
+from mesh_reader_cpp import create_mesh_reader, read_nas_file, STLReader, NASReader, MeshData, weld_vertices
 
 def test_stl_binary_reader():
     reader = STLReader()
@@ -42,4 +42,464 @@ def test_mesh_data_consistency():
     
     # Check that normals are normalized
     norms = np.linalg.norm(mesh_data.normals, axis=1)
-    assert np.allclose(norms, 1.0, rtol=1e-5) 
\ No newline at end of file
+    assert np.allclose(norms, 1.0, rtol=1e-5) 
+def _write_binary_stl(path, triangles, header=b"binary stl"):
+    import struct
+    with open(path, "wb") as f:
+        f.write(header.ljust(80, b"\0"))
+        f.write(struct.pack("<I", len(triangles)))
+        for normal, v1, v2, v3 in triangles:
+            f.write(struct.pack("<12f", *normal, *v1, *v2, *v3))
+            f.write(struct.pack("<H", 0))
+
+def test_stl_binary_reader_decodes_records(tmp_path):
+    path = tmp_path / "two.stl"
+    _write_binary_stl(path, [
+        ((0, 0, 1), (0, 0, 0), (1, 0, 0), (0, 1, 0)),
+        ((0, 0, 1), (1, 0, 0), (1, 1, 0), (0, 1, 0)),
+    ])
+    mesh_data = STLReader().read(str(path))
+
+    assert mesh_data.faces.shape == (2, 3)
+    assert np.allclose(mesh_data.vertices[mesh_data.faces[1]], [[1, 0, 0], [1, 1, 0], [0, 1, 0]])
+    assert np.allclose(mesh_data.normals, [[0, 0, 1], [0, 0, 1]])
+
+def test_stl_binary_reader_rejects_truncated_file(tmp_path):
+    path = tmp_path / "truncated.stl"
+    _write_binary_stl(path, [((0, 0, 1), (0, 0, 0), (1, 0, 0), (0, 1, 0))])
+    with open(path, "r+b") as f:
+        f.truncate(84 + 20)
+
+    with pytest.raises(RuntimeError):
+        STLReader().read(str(path))
+
+def test_stl_reader_welds_shared_vertices(tmp_path):
+    from mesh_reader_cpp import ReadOptions
+    path = tmp_path / "quad.stl"
+    _write_binary_stl(path, [
+        ((0, 0, 1), (0, 0, 0), (1, 0, 0), (0, 1, 0)),
+        ((0, 0, 1), (1, 0, 0), (1, 1, 0), (0, 1, 0)),
+    ])
+    options = ReadOptions()
+    options.weld_vertices = True
+    mesh_data = STLReader(options).read(str(path))
+
+    assert mesh_data.vertices.shape == (4, 3)
+    assert mesh_data.faces.tolist() == [[0, 1, 2], [1, 3, 2]]
+
+def test_nas_reader_resolves_forward_references(tmp_path):
+    path = tmp_path / "forward.nas"
+    path.write_text(
+        "CTRIA3         1       1       1       2       3\n"
+        "GRID*                  1               0             0.0             0.0\n"
+        "*                    0.0\n"
+        "GRID*                  2               0           1.0-3             0.0\n"
+        "*                    0.0\n"
+        "GRID*                  3               0             0.0             1.0\n"
+        "*                    2.5\n"
+    )
+    mesh_data = NASReader().read(str(path))
+
+    assert mesh_data.faces.tolist() == [[0, 1, 2]]
+    assert np.allclose(mesh_data.vertices, [[0, 0, 0], [1e-3, 0, 0], [0, 1, 2.5]])
+
+def test_nas_reader_thread_counts_agree():
+    from mesh_reader_cpp import ReadOptions
+    results = []
+    for num_threads in (1, 4):
+        options = ReadOptions()
+        options.num_threads = num_threads
+        options.use_cache = False
+        results.append(NASReader(options).read("data/car_highres.nas"))
+
+    assert np.array_equal(results[0].faces, results[1].faces)
+    assert np.array_equal(results[0].vertices, results[1].vertices)
+
+def test_nas_reader_card_formats(tmp_path):
+    from mesh_reader_cpp import ReadOptions
+    path = tmp_path / "cards.nas"
+    path.write_text(
+        "GRID           1             0.0     0.0     0.0\n"
+        "GRID           2             1.0     0.0     0.0\n"
+        "grid,3,,1.,1.,0.\n"
+        "GRID*                  4               0             0.0             1.0\n"
+        "*                    0.0\n"
+        "CTRIA6         1       1       1       2       3      11      12      13\n"
+        "CQUAD4         2       1       1       2       3       4\n"
+    )
+    mesh_data = NASReader().read(str(path))
+    assert mesh_data.vertices.shape == (4, 3)
+    assert mesh_data.faces.shape == (3, 3)
+
+    options = ReadOptions()
+    options.split_quads = False
+    mesh_data = NASReader(options).read(str(path))
+    assert mesh_data.faces.tolist() == [[0, 1, 2]]
+    assert mesh_data.quads.tolist() == [[0, 1, 2, 3]]
+
+def test_nas_reader_reuses_fresh_cache(tmp_path):
+    from mesh_reader_cpp import MeshCache, ReadOptions, mesh_cache_path, write_mesh_cache
+    import shutil
+    path = tmp_path / "car.nas"
+    shutil.copy("data/car_highres.nas", path)
+
+    parsed = create_mesh_reader(str(path)).read(str(path))
+    cache = MeshCache(mesh_cache_path(str(path)))
+    assert cache.is_fresh(str(path))
+    assert np.array_equal(cache.faces, parsed.faces)
+
+    cached = create_mesh_reader(str(path)).read(str(path))
+    assert np.array_equal(cached.vertices, parsed.vertices)
+
+    options = ReadOptions()
+    options.split_quads = False
+    assert not cache.is_fresh(str(path), options)
+
+    topo_path = str(tmp_path / "car.topo.cfdcache")
+    write_mesh_cache(topo_path, str(path), parsed, include_topology=True)
+    topo = MeshCache(topo_path)
+    assert topo.has_topology
+    assert topo.edge_face_offsets[-1] == 3 * len(parsed.faces)
+
+def test_corrupt_cache_is_rejected_and_rewritten(tmp_path):
+    from mesh_reader_cpp import MeshCache, mesh_cache_path
+    from pathlib import Path
+    import shutil
+    path = tmp_path / "car.nas"
+    shutil.copy("data/car_highres.nas", path)
+    parsed = create_mesh_reader(str(path)).read(str(path))
+    cache_path = mesh_cache_path(str(path))
+    # Written under a per-writer temporary name and renamed into place
+    assert sorted(p.name for p in tmp_path.iterdir()) == ["car.nas", "car.nas.cfdcache"]
+
+    # Zero the end of the face array, keeping the header and section sizes intact
+    data = bytearray(Path(cache_path).read_bytes())
+    data[-4096:] = bytes(4096)
+    Path(cache_path).write_bytes(bytes(data))
+    with pytest.raises(RuntimeError, match="checksum"):
+        MeshCache(cache_path)
+
+    reread = create_mesh_reader(str(path)).read(str(path))
+    assert np.array_equal(reread.faces, parsed.faces)
+    assert np.array_equal(MeshCache(cache_path).faces, parsed.faces)
+
+def test_iter_mesh_blocks_matches_read():
+    from mesh_reader_cpp import MeshBlock, ReadOptions, iter_mesh_blocks
+    options = ReadOptions()
+    options.use_cache = False
+    mesh_data = NASReader(options).read("data/car_highres.nas")
+
+    vertices, faces = [], []
+    for block in iter_mesh_blocks("data/car_highres.nas", 10000, options):
+        if block.kind == MeshBlock.Kind.Vertices:
+            assert block.first == sum(len(v) for v in vertices)
+            vertices.append(block.vertices)
+        elif block.kind == MeshBlock.Kind.Faces:
+            faces.append(block.faces)
+
+    assert np.allclose(np.vstack(vertices), mesh_data.vertices)
+    assert np.array_equal(np.vstack(faces), mesh_data.faces)
+
+def test_binary_stl_stream(tmp_path):
+    path = tmp_path / "tris.stl"
+    triangle = ((0, 0, 1), (0, 0, 0), (1, 0, 0), (0, 1, 0))
+    _write_binary_stl(path, [triangle] * 4)
+
+    blocks = list(STLReader().open_stream(str(path), 6))
+    assert [b.kind.name for b in blocks] == ["Vertices", "Faces", "Vertices", "Faces"]
+    assert blocks[2].vertices.shape == (6, 3)
+    assert blocks[3].first == 2
+    assert blocks[3].faces.tolist() == [[6, 7, 8], [9, 10, 11]]
+
+def test_mesh_data_arrays_are_views():
+    mesh_data = read_nas_file("data/test_cube.nas")
+    vertices = mesh_data.vertices
+    assert vertices.flags["C_CONTIGUOUS"]
+    assert not vertices.flags["OWNDATA"]
+    assert np.shares_memory(vertices, mesh_data.vertices)
+
+    assert not vertices.flags.writeable
+    first = float(vertices[0, 0])
+
+    # Mutators return a new MeshData, so earlier views keep valid storage
+    welded = weld_vertices(mesh_data)
+    with pytest.raises(AttributeError):
+        mesh_data.vertices = np.zeros((2, 3), dtype=np.float32)
+    assert welded.faces.shape == mesh_data.faces.shape
+
+    del mesh_data
+    assert vertices[0, 0] == first
+
+def test_mesh_data_from_arrays():
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0]], dtype=np.float64)
+    mesh_data = MeshData(vertices, np.array([[0, 1, 2]]))
+    assert mesh_data.vertices.dtype == np.float32
+    assert mesh_data.faces.tolist() == [[0, 1, 2]]
+    assert mesh_data.normals.shape == (0, 3)
+    assert mesh_data.quads.shape == (0, 4)
+
+    vertices[0, 0] = 5.0
+    assert mesh_data.vertices[0, 0] == 0.0
+    with pytest.raises(RuntimeError):
+        MeshData(vertices[:, :2], np.array([[0, 1, 2]]))
+
+def test_ascii_stl_multiple_solids(tmp_path):
+    path = tmp_path / "parts.stl"
+    path.write_text(
+        "solid wing left\n"
+        "  facet normal 0 0 1\n    outer loop\n"
+        "      vertex 0 0 0\n      vertex 1 0 0\n      vertex 0 1 0\n"
+        "    endloop\n  endfacet\n"
+        "endsolid wing left\n"
+        "SOLID body\n"
+        "facet normal 0 0 1 outer loop vertex 1 0 0 vertex 1 1 0\n\tvertex 0 1 0 endloop endfacet\n"
+        "facet normal 0 0 -1\r\nouter loop\r\nvertex 0 0 1.5e0\r\nvertex 1 0 1.5\r\nvertex 0 1 1.5\r\n"
+        "endloop\r\nendfacet\r\n"
+        "endsolid body\n"
+    )
+    mesh_data = STLReader().read(str(path))
+    assert mesh_data.faces.shape == (3, 3)
+    assert np.allclose(mesh_data.vertices[6], [0, 0, 1.5])
+    assert np.allclose(mesh_data.normals[2], [0, 0, -1])
+    assert [(s.name, s.first_face, s.face_count) for s in mesh_data.solids] == [
+        ("wing left", 0, 1), ("body", 1, 2)]
+
+    cached = STLReader().read(str(path))
+    assert [s.name for s in cached.solids] == ["wing left", "body"]
+
+def test_ascii_stl_rejects_short_facet(tmp_path):
+    path = tmp_path / "short.stl"
+    path.write_text("solid s\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\n"
+                    "endloop\nendfacet\nendsolid s\n")
+    with pytest.raises(RuntimeError):
+        STLReader().read(str(path))
+
+def test_binary_stl_with_solid_header(tmp_path):
+    path = tmp_path / "solid_header.stl"
+    _write_binary_stl(path, [((0, 0, 1), (0, 0, 0), (1, 0, 0), (0, 1, 0))],
+                      header=b"solid exported with a printable header")
+    mesh_data = STLReader().read(str(path))
+    assert mesh_data.faces.shape == (1, 3)
+    assert np.allclose(mesh_data.vertices[1], [1, 0, 0])
+
+@pytest.mark.parametrize("name,option", [
+    ("out.stl", None), ("out.stl", "ascii_stl"),
+    ("out.nas", None), ("out.nas", "nas_large_field"),
+])
+def test_write_mesh_round_trip(tmp_path, name, option):
+    from mesh_reader_cpp import ReadOptions, WriteOptions, write_mesh
+    read_options = ReadOptions()
+    read_options.use_cache = False
+    source = NASReader(read_options).read("data/car_highres.nas")
+
+    options = WriteOptions()
+    if option:
+        setattr(options, option, True)
+    path = str(tmp_path / name)
+    write_mesh(source, path, options)
+    written = create_mesh_reader(path, read_options).read(path)
+
+    assert len(written.faces) == len(source.faces)
+    if name.endswith(".nas"):
+        assert np.array_equal(written.faces, source.faces)
+        assert np.allclose(written.vertices, source.vertices, atol=1e-5)
+    else:
+        assert np.array_equal(written.vertices, source.vertices[source.faces.reshape(-1)])
+
+def test_cmz_round_trip(tmp_path):
+    import os
+    from mesh_reader_cpp import CMZReader, ReadOptions, write_mesh
+    read_options = ReadOptions()
+    read_options.use_cache = False
+    source = NASReader(read_options).read("data/car_highres.nas")
+
+    path = str(tmp_path / "car.cmz")
+    write_mesh(source, path)
+    assert os.path.getsize(path) * 5 < os.path.getsize("data/car_highres.nas")
+
+    for num_threads in (1, 4):
+        read_options.num_threads = num_threads
+        restored = CMZReader(read_options).read(path)
+        assert np.array_equal(restored.faces, source.faces)
+        extent = source.vertices.max(axis=0) - source.vertices.min(axis=0)
+        assert np.all(np.abs(restored.vertices - source.vertices) <= extent / 2**20)
+
+def test_cmz_rejects_truncated_file(tmp_path):
+    from mesh_reader_cpp import write_mesh
+    path = tmp_path / "cube.cmz"
+    write_mesh(read_nas_file("data/test_cube.nas"), str(path))
+    data = path.read_bytes()
+    path.write_bytes(data[:len(data) - 4])
+    with pytest.raises(RuntimeError):
+        create_mesh_reader(str(path)).read(str(path))
+
+def test_cmz_rejects_non_finite_coordinates(tmp_path):
+    from mesh_reader_cpp import write_mesh
+    faces = np.array([[0, 1, 2]], dtype=np.int32)
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0]], dtype=np.float32)
+    for bad in (np.nan, np.inf):
+        broken = vertices.copy()
+        broken[1, 2] = bad
+        with pytest.raises(RuntimeError, match="finite"):
+            write_mesh(MeshData(broken, faces), str(tmp_path / "bad.cmz"))
+    normals = np.array([[0, 0, np.nan]], dtype=np.float32)
+    with pytest.raises(RuntimeError, match="finite"):
+        write_mesh(MeshData(vertices, faces, normals), str(tmp_path / "bad.cmz"))
+
+def test_read_with_stats_reports_phases(tmp_path):
+    from mesh_reader_cpp import ReadOptions, read_with_stats
+    path = tmp_path / "partial.nas"
+    path.write_text(
+        "$ comment\n"
+        "BEGIN BULK\n"
+        "GRID           1             0.0     0.0     0.0\n"
+        "GRID           2             1.0     0.0     0.0\n"
+        "GRID           3             0.0     1.0     0.0\n"
+        "\n"
+        "CTRIA3         1       1       1       2       3\n"
+        "CTRIA3         2       1       1       2      99\n"
+        "CHEXA          3       1       1       2       3       4       5       6+\n"
+        "+              7       8\n"
+        "ENDDATA\n"
+    )
+    options = ReadOptions()
+    options.use_cache = False
+    mesh_data, stats = read_with_stats(str(path), options)
+
+    assert len(mesh_data.faces) == 1
+    assert stats.bytes_read == path.stat().st_size
+    assert stats.records_parsed == 5
+    # Only the CHEXA card; comments, blank lines, delimiters and its
+    # continuation line are not counted
+    assert stats.unsupported_records == 1
+    assert stats.lines_parsed == 11
+    assert stats.unresolved_elements == 1
+    assert not stats.from_cache
+    phases = stats.to_dict()["phase_seconds"]
+    assert {"tokenize", "resolve_nodes"} <= set(phases)
+    assert all(seconds >= 0 for seconds in phases.values())
+
+    reader = create_mesh_reader(str(path))
+    reader.read(str(path))
+    reader.read(str(path))
+    assert reader.last_stats.from_cache
+
+def test_mesh_handle_caches_topology():
+    from mesh_reader_cpp import Mesh
+    # Two triangles sharing the edge (1, 2)
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0], [1, 1, 0]], dtype=np.float32)
+    faces = np.array([[0, 1, 2], [1, 3, 2]], dtype=np.int64)
+    mesh = Mesh(vertices, faces)
+    assert mesh.num_vertices == 4 and mesh.num_faces == 2
+    assert mesh.cached == []
+
+    assert mesh.edges().tolist() == [[0, 1], [0, 2], [1, 2], [1, 3], [2, 3]]
+    offsets, edge_faces = mesh.edge_faces()
+    assert offsets.tolist() == [0, 1, 2, 4, 5, 6]
+    assert edge_faces.tolist() == [0, 0, 0, 1, 1, 1]
+    assert mesh.face_edges().tolist() == [[0, 2, 1], [3, 4, 2]]
+    offsets, vertex_faces = mesh.vertex_faces()
+    assert offsets.tolist() == [0, 1, 3, 5, 6]
+    assert vertex_faces.tolist() == [0, 0, 1, 0, 1, 1]
+    assert np.allclose(mesh.face_normals(), [[0, 0, 1], [0, 0, 1]])
+    assert np.allclose(mesh.face_boxes()[1], [0, 0, 0, 1, 1, 0])
+    assert sorted(mesh.cached) == ["edges", "face_boxes", "face_normals", "vertex_faces"]
+    assert not mesh.faces.flags.writeable
+
+    with pytest.raises(RuntimeError):
+        Mesh(vertices, np.array([[0, 1, 4]]))
+
+
+def test_mesh_rejects_indices_that_would_wrap():
+    from mesh_reader_cpp import Mesh
+    vertices = np.zeros((6, 3), dtype=np.float64)
+    # 2**32 + 5 would become the valid index 5 if narrowed to int32 first
+    for dtype in (np.int64, np.uint64, np.uint32):
+        faces = np.array([[0, 1, 2]], dtype=dtype)
+        faces[0, 0] = 2**32 - 1 if dtype == np.uint32 else 2**32 + 5
+        with pytest.raises(RuntimeError):
+            Mesh(vertices, faces)
+    with pytest.raises(RuntimeError):
+        Mesh(vertices, np.array([[-1, 1, 2]], dtype=np.int64))
+    assert Mesh(vertices, np.array([[0, 1, 5]], dtype=np.uint64)).faces.tolist() == [[0, 1, 5]]
+
+
+def test_mesh_face_normals_of_small_faces():
+    from mesh_reader_cpp import Mesh
+    # A 0.1 mm right triangle in metres (|n| = 1e-8), a 1 um one, and a
+    # collinear face
+    vertices = np.array([[0, 0, 0], [1e-4, 0, 0], [0, 1e-4, 0],
+                         [0, 0, 1], [1e-6, 0, 1], [0, 0, 1 + 1e-6],
+                         [0, 0, 2], [1, 0, 2], [2, 0, 2]], dtype=np.float64)
+    faces = np.array([[0, 1, 2], [3, 4, 5], [6, 7, 8]], dtype=np.int32)
+    normals = Mesh(vertices, faces).face_normals()
+    assert np.allclose(normals[:2], [[0, 0, 1], [0, -1, 0]])
+    assert normals[2].tolist() == [0, 0, 0]
+
+
+def test_mesh_free_and_non_manifold_edges():
+    from mesh_reader_cpp import Mesh
+    # Three triangles fanned around the edge (0, 1), plus one separate triangle
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0], [0, -1, 0], [0, 0, 1],
+                         [5, 0, 0], [6, 0, 0], [5, 1, 0]], dtype=np.float64)
+    faces = np.array([[0, 1, 2], [1, 0, 3], [0, 1, 4], [5, 6, 7]], dtype=np.int32)
+    mesh = Mesh(vertices, faces)
+    edges = mesh.edges()
+
+    assert [tuple(edges[e]) for e in mesh.non_manifold_edges()] == [(0, 1)]
+    offsets, edge_faces = mesh.edge_faces()
+    e = mesh.non_manifold_edges()[0]
+    assert edge_faces[offsets[e]:offsets[e + 1]].tolist() == [0, 1, 2]
+    assert [tuple(edges[e]) for e in mesh.free_edges()] == [
+        (0, 2), (0, 3), (0, 4), (1, 2), (1, 3), (1, 4), (5, 6), (5, 7), (6, 7)]
+
+
+def test_mesh_boundary_loops():
+    from mesh_reader_cpp import Mesh
+    # 4 x 4 unit grid with the centre 2 x 2 cells removed
+    n = 4
+    vertices = np.array([[i, j, 0] for j in range(n + 1) for i in range(n + 1)], dtype=np.float64)
+    faces = []
+    for j in range(n):
+        for i in range(n):
+            if i in (1, 2) and j in (1, 2):
+                continue
+            a = j * (n + 1) + i
+            faces += [[a, a + 1, a + n + 2], [a, a + n + 2, a + n + 1]]
+    loops = Mesh(vertices, np.array(faces)).boundary_loops()
+
+    assert loops["closed"].tolist() == [True, True]
+    assert loops["edge_count"].tolist() == [16, 8]
+    assert np.allclose(loops["perimeter"], [16.0, 8.0])
+    assert np.allclose(loops["area"], [16.0, 4.0])
+    assert np.allclose(loops["bbox"][1], [1, 1, 0, 3, 3, 0])
+    offsets, loop_vertices = loops["offsets"], loops["vertices"]
+    assert offsets.tolist() == [0, 16, 24]
+    # The outer loop follows the counter-clockwise face winding from vertex 0
+    assert loop_vertices[:3].tolist() == [0, 1, 2]
+
+
+def test_mesh_vertex_faces_skips_isolated_and_repeated_vertices():
+    from mesh_reader_cpp import Mesh
+    vertices = np.zeros((8, 3), dtype=np.float32)
+    faces = np.array([[2, 3, 4], [4, 4, 5], [3, 2, 5]], dtype=np.int32)
+    offsets, vertex_faces = Mesh(vertices, faces).vertex_faces()
+    assert offsets.tolist() == [0, 0, 0, 2, 4, 6, 8, 8, 8]
+    assert vertex_faces.tolist() == [0, 2, 0, 2, 0, 1, 1, 2]
+
+
+def test_mesh_face_quality():
+    from mesh_reader_cpp import Mesh
+    h = np.sqrt(3.0) / 2
+    # Equilateral, right isosceles, sliver and degenerate (repeated corner),
+    # placed far from the origin
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0.5, h, 0], [0, 1, 0],
+                         [2, 0, 0], [4, 1e-4, 0]], dtype=np.float64) + 1e6
+    faces = np.array([[0, 1, 2], [0, 1, 3], [0, 4, 5], [0, 1, 1]], dtype=np.int32)
+    quality = Mesh(vertices, faces).face_quality()
+
+    assert quality.dtype == np.float32
+    right = 2 * (np.sqrt(2) - 1)  # r = (2 - sqrt(2)) / 2, R = sqrt(2) / 2
+    assert np.allclose(quality[:2], [1.0, right], atol=1e-5)
+    assert 0 < quality[2] < 1e-3
+    assert quality[3] == 0
@@ -0,0 +1,45 @@
+import pytest
+import numpy as np
+
+non_manifold_vertices_cpp = pytest.importorskip("non_manifold_vertices_cpp")
+
+
+def _fan_test_mesh():
+    # Vertex 0: bow-tie, two triangles meeting only at the vertex
+    # Vertices 5, 6: ends of the edge (5, 6), shared by three triangles
+    # Vertices 10-13: a two-triangle strip, 11 is an ordinary boundary vertex
+    vertices = np.array([[i, i % 3, i % 5] for i in range(14)], dtype=np.float64)
+    faces = np.array([[0, 1, 2], [0, 3, 4],
+                      [5, 6, 7], [6, 5, 8], [5, 6, 9],
+                      [10, 11, 12], [11, 13, 12]], dtype=np.int32)
+    return vertices, faces
+
+
+def test_fan_analysis_arrays():
+    vertices, faces = _fan_test_mesh()
+    fans = non_manifold_vertices_cpp.analyze_vertex_fans(vertices, faces)
+
+    assert fans["fan_count"][0] == 2
+    assert fans["free_edge_count"][0] == 4
+    assert not fans["non_manifold_edge"][0]
+
+    assert fans["fan_count"][5] == 1
+    assert fans["free_edge_count"][5] == 3
+    assert fans["non_manifold_edge"][5] and fans["non_manifold_edge"][6]
+
+    assert fans["fan_count"][11] == 1
+    assert fans["free_edge_count"][11] == 2
+    assert not fans["non_manifold_edge"][11]
+
+
+def test_fan_detection_flags_bow_tie_and_non_manifold_edge():
+    vertices, faces = _fan_test_mesh()
+    detected, seconds = non_manifold_vertices_cpp.detect_non_manifold_vertices_fans_with_timing(
+        vertices, faces)
+    assert sorted(detected) == [0, 5, 6]
+    assert seconds >= 0.0
+
+    # The free-edge definition only sees the bow-tie (four free edges)
+    detected, _ = non_manifold_vertices_cpp.detect_non_manifold_vertices_with_timing(
+        vertices, faces, 0.0)
+    assert sorted(detected) == [0]
@@ -0,0 +1,69 @@
+import pytest
+import numpy as np
+
+overlapping_edges_cpp = pytest.importorskip("overlapping_edges_cpp")
+
+
+def _t_junction(numbering):
+    # Long edge A-C under one face; A-B and B-C over two others, with B
+    # 0.6e-3 off the line. numbering maps "A", "B", "C" to vertex indices 0-2.
+    points = {"A": (0, 0, 0), "B": (1, 0.6e-3, 0), "C": (3, 0, 0)}
+    vertices = [None] * 3
+    for name, index in numbering.items():
+        vertices[index] = points[name]
+    vertices += [(1.5, -2, 0), (0.5, 2, 0), (2, 2, 0)]
+    a, b, c = numbering["A"], numbering["B"], numbering["C"]
+    faces = [[a, c, 3], [a, b, 4], [b, c, 5]]
+    return np.array(vertices, dtype=np.float64), np.array(faces, dtype=np.int32)
+
+
+def _edge(numbering, p, q):
+    return sorted([numbering[p], numbering[q]])
+
+
+@pytest.mark.parametrize("numbering", [
+    {"A": 0, "B": 1, "C": 2},  # short edge A-B has the lower edge id
+    {"A": 0, "C": 1, "B": 2},  # long edge A-C has the lower edge id
+])
+def test_collinear_t_junction_with_either_numbering(numbering):
+    vertices, faces = _t_junction(numbering)
+    edges, _ = overlapping_edges_cpp.detect_overlapping_edges_with_timing(vertices, faces, 1e-3)
+    expected = sorted([_edge(numbering, "A", "B"), _edge(numbering, "B", "C"),
+                       _edge(numbering, "A", "C")])
+    assert edges == expected
+
+    details = overlapping_edges_cpp.find_overlapping_edges(vertices, faces, 1e-3)
+    assert details["duplicates"].shape == (0, 2)
+    pairs = {frozenset([tuple(row[:2]), tuple(row[2:])]) for row in details["partial_overlaps"].tolist()}
+    long_edge = tuple(_edge(numbering, "A", "C"))
+    assert pairs == {frozenset([tuple(_edge(numbering, "A", "B")), long_edge]),
+                     frozenset([tuple(_edge(numbering, "B", "C")), long_edge])}
+
+
+def test_duplicate_edge_within_tolerance():
+    # Three faces on the edge (0,0,0)-(1,0,0), each with its own vertex
+    # copies up to 1e-7 apart
+    vertices = np.array([[0, 0, 0], [1, 0, 0], [0.5, 1, 0],
+                         [1e-7, 0, 0], [1, 1e-7, 0], [0.5, -1, 0],
+                         [0, 0, -1e-7], [1 - 1e-7, 0, 0], [0.5, 0, 1]], dtype=np.float64)
+    faces = np.array([[0, 1, 2], [3, 4, 5], [6, 7, 8]], dtype=np.int32)
+
+    edges, _ = overlapping_edges_cpp.detect_overlapping_edges_with_timing(vertices, faces, 1e-5)
+    assert edges == [[0, 1]]
+    details = overlapping_edges_cpp.find_overlapping_edges(vertices, faces, 1e-5)
+    assert details["duplicates"].tolist() == [[0, 1]]
+    assert details["duplicate_uses"].tolist() == [3]
+    assert details["partial_overlaps"].shape == (0, 4)
+
+    # Below the copies' spread the edges stay apart
+    edges, _ = overlapping_edges_cpp.detect_overlapping_edges_with_timing(vertices, faces, 1e-8)
+    assert edges == []
+
+
+@pytest.mark.parametrize("tolerance", [0.0, -1e-5])
+def test_non_positive_tolerance_raises(tolerance):
+    vertices, faces = _t_junction({"A": 0, "B": 1, "C": 2})
+    with pytest.raises(RuntimeError):
+        overlapping_edges_cpp.detect_overlapping_edges_with_timing(vertices, faces, tolerance)
+    with pytest.raises(RuntimeError):
+        overlapping_edges_cpp.find_overlapping_edges(vertices, faces, tolerance)